@@ -14,48 +14,152 @@
 #include <cctype>
 #include <limits>
 #include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <utility>
+#include <new>
+#include <cmath>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__)
+    #include <emmintrin.h>
+#endif
 
 // ==================== ESTRUCTURAS DE DATOS ====================
 
 /**
- * @brief Implementación de una lista enlazada genérica
+ * @brief Implementación de una lista genérica sobre un arreglo dinámico
+ *
+ * Los elementos se guardan de forma contigua: el acceso por índice es O(1) y
+ * agregar al final es O(1) amortizado (la capacidad se duplica al llenarse).
  */
 template <typename T>
 class Lista {
 private:
-    struct Nodo {
-        T dato;
-        Nodo* siguiente;
+    T* datos;
+    int capacidad;
+    int tamanio;
 
-        Nodo(const T& _dato) : dato(_dato), siguiente(nullptr) {}
-    };
+    // Mover los elementos a un bloque de la capacidad indicada
+    void redimensionar(int nuevaCapacidad) {
+        T* nuevos = static_cast<T*>(::operator new(sizeof(T) * static_cast<size_t>(nuevaCapacidad)));
 
-    Nodo* primero;
-    Nodo* ultimo;
-    int tamanio;
+        for (int i = 0; i < tamanio; i++) {
+            new (&nuevos[i]) T(std::move_if_noexcept(datos[i]));
+            datos[i].~T();
+        }
+
+        ::operator delete(datos);
+        datos = nuevos;
+        capacidad = nuevaCapacidad;
+    }
+
+    // Asegurar espacio para un elemento más
+    void crecerSiEsNecesario() {
+        if (tamanio == capacidad) {
+            redimensionar(capacidad == 0 ? 4 : capacidad * 2);
+        }
+    }
 
 public:
+    typedef T* iterador;
+    typedef const T* iteradorConstante;
+
     // Constructor
-    Lista() : primero(nullptr), ultimo(nullptr), tamanio(0) {}
+    Lista() : datos(nullptr), capacidad(0), tamanio(0) {}
+
+    // Constructor de copia
+    Lista(const Lista& otra) : datos(nullptr), capacidad(0), tamanio(0) {
+        reservar(otra.tamanio);
+        for (int i = 0; i < otra.tamanio; i++) {
+            new (&datos[i]) T(otra.datos[i]);
+            tamanio++;
+        }
+    }
+
+    // Constructor de movimiento
+    Lista(Lista&& otra) noexcept : datos(otra.datos), capacidad(otra.capacidad), tamanio(otra.tamanio) {
+        otra.datos = nullptr;
+        otra.capacidad = 0;
+        otra.tamanio = 0;
+    }
+
+    // Asignación por copia
+    Lista& operator=(const Lista& otra) {
+        if (this != &otra) {
+            Lista copia(otra);
+            *this = std::move(copia);
+        }
+        return *this;
+    }
+
+    // Asignación por movimiento
+    Lista& operator=(Lista&& otra) noexcept {
+        if (this != &otra) {
+            vaciar();
+            ::operator delete(datos);
+
+            datos = otra.datos;
+            capacidad = otra.capacidad;
+            tamanio = otra.tamanio;
+
+            otra.datos = nullptr;
+            otra.capacidad = 0;
+            otra.tamanio = 0;
+        }
+        return *this;
+    }
 
     // Destructor
     ~Lista() {
         vaciar();
+        ::operator delete(datos);
     }
 
-    // Agregar elemento al final
-    void agregar(const T& elemento) {
-        Nodo* nuevo = new Nodo(elemento);
+    // Reservar capacidad para al menos la cantidad indicada de elementos
+    void reservar(int nuevaCapacidad) {
+        if (nuevaCapacidad > capacidad) {
+            redimensionar(nuevaCapacidad);
+        }
+    }
 
-        if (primero == nullptr) {
-            primero = nuevo;
-            ultimo = nuevo;
+    // Construir un elemento al final a partir de sus argumentos
+    template <typename... Args>
+    T& emplazar(Args&&... args) {
+        if (tamanio == capacidad) {
+            // Los argumentos podrían referirse a elementos de esta misma lista
+            T nuevo(std::forward<Args>(args)...);
+            crecerSiEsNecesario();
+            new (&datos[tamanio]) T(std::move(nuevo));
         } else {
-            ultimo->siguiente = nuevo;
-            ultimo = nuevo;
+            new (&datos[tamanio]) T(std::forward<Args>(args)...);
         }
 
-        tamanio++;
+        return datos[tamanio++];
+    }
+
+    // Agregar elemento al final
+    void agregar(const T& elemento) {
+        emplazar(elemento);
+    }
+
+    void agregar(T&& elemento) {
+        emplazar(std::move(elemento));
     }
 
     // Insertar elemento en una posición específica
@@ -64,32 +168,20 @@ public:
             return false;
         }
 
-        if (indice == 0) {
-            Nodo* nuevo = new Nodo(elemento);
-            nuevo->siguiente = primero;
-            primero = nuevo;
-
-            if (ultimo == nullptr) {
-                ultimo = nuevo;
-            }
-
-            tamanio++;
-            return true;
-        }
-
         if (indice == tamanio) {
             agregar(elemento);
             return true;
         }
 
-        Nodo* actual = primero;
-        for (int i = 0; i < indice - 1; i++) {
-            actual = actual->siguiente;
-        }
+        T copia(elemento);
+        crecerSiEsNecesario();
 
-        Nodo* nuevo = new Nodo(elemento);
-        nuevo->siguiente = actual->siguiente;
-        actual->siguiente = nuevo;
+        // Desplazar una posición a la derecha los elementos desde el índice
+        new (&datos[tamanio]) T(std::move(datos[tamanio - 1]));
+        for (int i = tamanio - 1; i > indice; i--) {
+            datos[i] = std::move(datos[i - 1]);
+        }
+        datos[indice] = std::move(copia);
 
         tamanio++;
         return true;
@@ -97,34 +189,16 @@ public:
 
     // Eliminar elemento en una posición específica
     bool eliminar(int indice) {
-        if (indice < 0 || indice >= tamanio || primero == nullptr) {
+        if (indice < 0 || indice >= tamanio) {
             return false;
         }
 
-        Nodo* aEliminar;
-
-        if (indice == 0) {
-            aEliminar = primero;
-            primero = primero->siguiente;
-
-            if (primero == nullptr) {
-                ultimo = nullptr;
-            }
-        } else {
-            Nodo* actual = primero;
-            for (int i = 0; i < indice - 1; i++) {
-                actual = actual->siguiente;
-            }
-
-            aEliminar = actual->siguiente;
-            actual->siguiente = aEliminar->siguiente;
-
-            if (aEliminar == ultimo) {
-                ultimo = actual;
-            }
+        // Desplazar una posición a la izquierda los elementos posteriores
+        for (int i = indice; i < tamanio - 1; i++) {
+            datos[i] = std::move(datos[i + 1]);
         }
 
-        delete aEliminar;
+        datos[tamanio - 1].~T();
         tamanio--;
         return true;
     }
@@ -135,41 +209,33 @@ public:
             return false;
         }
 
-        Nodo* actual = primero;
-        for (int i = 0; i < indice; i++) {
-            actual = actual->siguiente;
-        }
-
-        actual->dato = elemento;
+        datos[indice] = elemento;
         return true;
     }
 
     // Obtener elemento en una posición específica
-    T obtener(int indice) const {
+    const T& obtener(int indice) const {
         if (indice < 0 || indice >= tamanio) {
             throw std::out_of_range("Índice fuera de rango");
         }
 
-        Nodo* actual = primero;
-        for (int i = 0; i < indice; i++) {
-            actual = actual->siguiente;
+        return datos[indice];
+    }
+
+    T& obtener(int indice) {
+        if (indice < 0 || indice >= tamanio) {
+            throw std::out_of_range("Índice fuera de rango");
         }
 
-        return actual->dato;
+        return datos[indice];
     }
 
     // Buscar índice de un elemento
     int buscar(const T& elemento) const {
-        Nodo* actual = primero;
-        int indice = 0;
-
-        while (actual != nullptr) {
-            if (actual->dato == elemento) {
-                return indice;
+        for (int i = 0; i < tamanio; i++) {
+            if (datos[i] == elemento) {
+                return i;
             }
-
-            actual = actual->siguiente;
-            indice++;
         }
 
         return -1;
@@ -185,55 +251,84 @@ public:
         return tamanio;
     }
 
+    // Obtener capacidad reservada
+    int obtenerCapacidad() const {
+        return capacidad;
+    }
+
     // Verificar si la lista está vacía
     bool estaVacia() const {
         return tamanio == 0;
     }
 
-    // Vaciar la lista
+    // Vaciar la lista (conserva la capacidad reservada)
     void vaciar() {
-        while (primero != nullptr) {
-            Nodo* temp = primero;
-            primero = primero->siguiente;
-            delete temp;
+        for (int i = 0; i < tamanio; i++) {
+            datos[i].~T();
         }
 
-        ultimo = nullptr;
         tamanio = 0;
     }
+
+    // Iteradores para recorrer la lista en orden
+    iterador begin() {
+        return datos;
+    }
+
+    iterador end() {
+        return datos + tamanio;
+    }
+
+    iteradorConstante begin() const {
+        return datos;
+    }
+
+    iteradorConstante end() const {
+        return datos + tamanio;
+    }
 };
 
 /**
- * @brief Implementación de una pila genérica
+ * @brief Pila de capacidad fija sobre un búfer circular
+ *
+ * Los elementos viven en un arreglo reservado al crearla. Apilar con la pila llena
+ * sobrescribe el elemento más antiguo, así que apilar, desapilar y descartar el más
+ * antiguo son O(1) y no reservan memoria.
  */
 template <typename T>
-class Pila {
+class PilaCircular {
 private:
-    struct Nodo {
-        T dato;
-        Nodo* siguiente;
-
-        Nodo(const T& _dato) : dato(_dato), siguiente(nullptr) {}
-    };
-
-    Nodo* cima_;
+    Lista<T> datos;   // Siempre con 'capacidad' elementos construidos
+    int inicio;       // Posición del elemento más antiguo
     int tamanio;
 
-public:
-    // Constructor
-    Pila() : cima_(nullptr), tamanio(0) {}
+    // Posición en el arreglo del elemento que ocupa el lugar indicado desde el más antiguo
+    int posicion(int desdeElMasAntiguo) const {
+        int p = inicio + desdeElMasAntiguo;
+        return p >= datos.obtenerTamanio() ? p - datos.obtenerTamanio() : p;
+    }
 
-    // Destructor
-    ~Pila() {
-        vaciar();
+public:
+    // Constructor: capacidad mínima de un elemento
+    explicit PilaCircular(int capacidad = 1) : inicio(0), tamanio(0) {
+        capacidad = std::max(1, capacidad);
+        datos.reservar(capacidad);
+        for (int i = 0; i < capacidad; i++) {
+            datos.emplazar();
+        }
     }
 
-    // Apilar elemento
-    void apilar(const T& elemento) {
-        Nodo* nuevo = new Nodo(elemento);
-        nuevo->siguiente = cima_;
-        cima_ = nuevo;
+    // Apilar elemento; devuelve true si para hacerle sitio se descartó el más antiguo
+    bool apilar(const T& elemento) {
+        if (tamanio == datos.obtenerTamanio()) {
+            datos.obtener(inicio) = elemento;
+            inicio = posicion(1);
+            return true;
+        }
+
+        datos.obtener(posicion(tamanio)) = elemento;
         tamanio++;
+        return false;
     }
 
     // Desapilar elemento
@@ -241,20 +336,51 @@ public:
         if (estaVacia()) {
             return false;
         }
-
-        Nodo* temp = cima_;
-        cima_ = cima_->siguiente;
-        delete temp;
         tamanio--;
+        datos.obtener(posicion(tamanio)) = T();
         return true;
     }
 
     // Obtener elemento en la cima
-    T cima() const {
+    const T& cima() const {
+        if (estaVacia()) {
+            throw std::out_of_range("La pila está vacía");
+        }
+        return datos.obtener(posicion(tamanio - 1));
+    }
+
+    T& cima() {
         if (estaVacia()) {
             throw std::out_of_range("La pila está vacía");
         }
-        return cima_->dato;
+        return datos.obtener(posicion(tamanio - 1));
+    }
+
+    // Obtener un elemento por su distancia a la cima (0 es la cima)
+    const T& obtener(int desdeLaCima) const {
+        if (desdeLaCima < 0 || desdeLaCima >= tamanio) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+        return datos.obtener(posicion(tamanio - 1 - desdeLaCima));
+    }
+
+    // Cambiar la capacidad conservando los elementos más recientes
+    void redimensionar(int capacidad) {
+        capacidad = std::max(1, capacidad);
+        int conservados = std::min(tamanio, capacidad);
+
+        Lista<T> nuevos;
+        nuevos.reservar(capacidad);
+        for (int i = tamanio - conservados; i < tamanio; i++) {
+            nuevos.agregar(std::move(datos.obtener(posicion(i))));
+        }
+        while (nuevos.obtenerTamanio() < capacidad) {
+            nuevos.emplazar();
+        }
+
+        datos = std::move(nuevos);
+        inicio = 0;
+        tamanio = conservados;
     }
 
     // Verificar si la pila está vacía
@@ -262,84 +388,217 @@ public:
         return tamanio == 0;
     }
 
+    // Verificar si el próximo elemento apilado descartará al más antiguo
+    bool estaLlena() const {
+        return tamanio == datos.obtenerTamanio();
+    }
+
     // Obtener tamaño de la pila
     int obtenerTamanio() const {
         return tamanio;
     }
 
-    // Vaciar la pila
+    int obtenerCapacidad() const {
+        return datos.obtenerTamanio();
+    }
+
+    // Vaciar la pila (conserva el arreglo reservado)
     void vaciar() {
         while (!estaVacia()) {
             desapilar();
         }
+        inicio = 0;
     }
 };
 
 /**
- * @brief Implementación de una cola genérica
+ * @brief Cola doble con acceso por posición sobre un búfer circular
+ *
+ * La capacidad es siempre potencia de dos para calcular posiciones con una máscara.
+ * Agregar y quitar por ambos extremos es O(1) amortizado; insertar, eliminar o mover
+ * en medio desplaza solo el lado más corto, O(min(i, n - i)).
  */
 template <typename T>
-class Cola {
+class ColaDoble {
 private:
-    struct Nodo {
-        T dato;
-        Nodo* siguiente;
+    Lista<T> datos;   // Siempre con 'capacidad' elementos construidos
+    int inicio;       // Posición del primer elemento
+    int tamanio;
 
-        Nodo(const T& _dato) : dato(_dato), siguiente(nullptr) {}
-    };
+    // Elemento en la posición lógica indicada (sin comprobar rango)
+    T& en(int posicion) {
+        return datos.obtener((inicio + posicion) & (datos.obtenerTamanio() - 1));
+    }
 
-    Nodo* frente_;
-    Nodo* final_;
-    int tamanio;
+    const T& en(int posicion) const {
+        return datos.obtener((inicio + posicion) & (datos.obtenerTamanio() - 1));
+    }
+
+    // Copiar los elementos en orden a un arreglo nuevo de la capacidad indicada
+    void cambiarCapacidad(int capacidad) {
+        Lista<T> nuevos;
+        nuevos.reservar(capacidad);
+        for (int i = 0; i < tamanio; i++) {
+            nuevos.agregar(std::move(en(i)));
+        }
+        while (nuevos.obtenerTamanio() < capacidad) {
+            nuevos.emplazar();
+        }
+
+        datos = std::move(nuevos);
+        inicio = 0;
+    }
 
 public:
     // Constructor
-    Cola() : frente_(nullptr), final_(nullptr), tamanio(0) {}
+    ColaDoble() : inicio(0), tamanio(0) {
+        datos.emplazar();
+    }
 
-    // Destructor
-    ~Cola() {
-        vaciar();
+    // Asegurar espacio para al menos la cantidad indicada de elementos
+    void reservar(int cantidad) {
+        int capacidad = datos.obtenerTamanio();
+        if (cantidad <= capacidad) {
+            return;
+        }
+        while (capacidad < cantidad) {
+            capacidad *= 2;
+        }
+        cambiarCapacidad(capacidad);
     }
 
-    // Encolar elemento
-    void encolar(const T& elemento) {
-        Nodo* nuevo = new Nodo(elemento);
+    // Agregar elemento al final
+    void agregarAlFinal(const T& elemento) {
+        reservar(tamanio + 1);
+        en(tamanio) = elemento;
+        tamanio++;
+    }
+
+    // Agregar elemento al frente
+    void agregarAlFrente(const T& elemento) {
+        reservar(tamanio + 1);
+        inicio = (inicio - 1) & (datos.obtenerTamanio() - 1);
+        en(0) = elemento;
+        tamanio++;
+    }
+
+    // Agregar al final los elementos de una lista a partir de la posición indicada
+    void agregarVarios(const Lista<T>& elementos, int desde = 0) {
+        desde = std::max(0, desde);
+        if (desde >= elementos.obtenerTamanio()) {
+            return;
+        }
 
+        reservar(tamanio + elementos.obtenerTamanio() - desde);
+        for (int i = desde; i < elementos.obtenerTamanio(); i++) {
+            en(tamanio) = elementos.obtener(i);
+            tamanio++;
+        }
+    }
+
+    // Quitar elemento del frente
+    bool quitarDelFrente() {
+        if (estaVacia()) {
+            return false;
+        }
+        en(0) = T();
+        inicio = (inicio + 1) & (datos.obtenerTamanio() - 1);
+        tamanio--;
+        return true;
+    }
+
+    // Quitar elemento del final
+    bool quitarDelFinal() {
         if (estaVacia()) {
-            frente_ = nuevo;
-            final_ = nuevo;
+            return false;
+        }
+        tamanio--;
+        en(tamanio) = T();
+        return true;
+    }
+
+    // Insertar elemento en la posición indicada
+    bool insertar(int posicion, const T& elemento) {
+        if (posicion < 0 || posicion > tamanio) {
+            return false;
+        }
+
+        reservar(tamanio + 1);
+        if (posicion < tamanio / 2) {
+            // Correr hacia atrás los elementos anteriores
+            inicio = (inicio - 1) & (datos.obtenerTamanio() - 1);
+            for (int i = 0; i < posicion; i++) {
+                en(i) = std::move(en(i + 1));
+            }
         } else {
-            final_->siguiente = nuevo;
-            final_ = nuevo;
+            for (int i = tamanio; i > posicion; i--) {
+                en(i) = std::move(en(i - 1));
+            }
         }
 
+        en(posicion) = elemento;
         tamanio++;
+        return true;
     }
 
-    // Desencolar elemento
-    bool desencolar() {
-        if (estaVacia()) {
+    // Eliminar elemento en la posición indicada
+    bool eliminar(int posicion) {
+        if (posicion < 0 || posicion >= tamanio) {
             return false;
         }
 
-        Nodo* temp = frente_;
-        frente_ = frente_->siguiente;
+        if (posicion < tamanio / 2) {
+            // Correr hacia adelante los elementos anteriores
+            for (int i = posicion; i > 0; i--) {
+                en(i) = std::move(en(i - 1));
+            }
+            return quitarDelFrente();
+        }
+
+        for (int i = posicion; i < tamanio - 1; i++) {
+            en(i) = std::move(en(i + 1));
+        }
+        return quitarDelFinal();
+    }
 
-        if (frente_ == nullptr) {
-            final_ = nullptr;
+    // Mover un elemento a otra posición, desplazando los que quedan entre ambas
+    bool mover(int desde, int hasta) {
+        if (desde < 0 || desde >= tamanio || hasta < 0 || hasta >= tamanio) {
+            return false;
         }
 
-        delete temp;
-        tamanio--;
+        T elemento = std::move(en(desde));
+        for (int i = desde; i < hasta; i++) {
+            en(i) = std::move(en(i + 1));
+        }
+        for (int i = desde; i > hasta; i--) {
+            en(i) = std::move(en(i - 1));
+        }
+        en(hasta) = std::move(elemento);
         return true;
     }
 
-    // Obtener elemento en el frente
-    T frente() const {
+    // Obtener elemento por posición (0 es el frente)
+    T& obtener(int posicion) {
+        if (posicion < 0 || posicion >= tamanio) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+        return en(posicion);
+    }
+
+    const T& obtener(int posicion) const {
+        if (posicion < 0 || posicion >= tamanio) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+        return en(posicion);
+    }
+
+    // Obtener elemento del frente
+    const T& frente() const {
         if (estaVacia()) {
             throw std::out_of_range("La cola está vacía");
         }
-        return frente_->dato;
+        return en(0);
     }
 
     // Verificar si la cola está vacía
@@ -352,660 +611,6234 @@ public:
         return tamanio;
     }
 
-    // Vaciar la cola
+    // Vaciar la cola (conserva el arreglo reservado)
     void vaciar() {
         while (!estaVacia()) {
-            desencolar();
+            quitarDelFinal();
         }
+        inicio = 0;
     }
 };
 
 /**
- * @brief Implementación de un grafo dirigido
+ * @brief Secuencia persistente con estructura compartida (treap implícito)
+ *
+ * Copiar una secuencia es O(1): las copias comparten los nodos, que cuentan sus
+ * referencias. Al modificar se copian solo los nodos compartidos del camino tocado,
+ * O(log n) esperado, y un nodo que no comparte nadie se modifica en el mismo lugar.
+ * Así cada versión anterior sigue intacta mientras alguien la conserve. Los nodos
+ * liberados se guardan para reutilizarlos en lugar de devolverlos al sistema.
  */
 template <typename T>
-class Grafo {
+class SecuenciaPersistente {
 private:
-    struct Arista {
-        int destino;
-        int peso;
+    struct Nodo {
+        T dato;
+        Nodo* izquierdo;
+        Nodo* derecho;
+        int tamanio;
+        unsigned int prioridad;
+        int referencias;
+
+        Nodo(const T& _dato, unsigned int _prioridad)
+            : dato(_dato), izquierdo(nullptr), derecho(nullptr), tamanio(1), prioridad(_prioridad), referencias(1) {}
+    };
 
-        Arista(int _destino, int _peso = 1) : destino(_destino), peso(_peso) {}
+    Nodo* raiz;
 
-        bool operator==(const Arista& otra) const {
-            return destino == otra.destino && peso == otra.peso;
+    static int tamanioDe(const Nodo* nodo) {
+        return nodo != nullptr ? nodo->tamanio : 0;
+    }
+
+    static void actualizar(Nodo* nodo) {
+        nodo->tamanio = 1 + tamanioDe(nodo->izquierdo) + tamanioDe(nodo->derecho);
+    }
+
+    // Prioridades pseudoaleatorias (xorshift) para mantener el árbol equilibrado
+    static unsigned int nuevaPrioridad() {
+        static unsigned int estado = 2463534242u;
+        estado ^= estado << 13;
+        estado ^= estado >> 17;
+        estado ^= estado << 5;
+        return estado;
+    }
+
+    // Nodos liberados que se reutilizan antes de pedir memoria nueva: una secuencia de
+    // tamaño acotado, como el historial, deja de reservar memoria una vez en marcha
+    static const int MAX_NODOS_LIBRES = 4096;
+
+    struct NodosLibres {
+        Nodo* primero;      // Enlazados por 'izquierdo'
+        int cantidad;
+
+        ~NodosLibres() {
+            while (primero != nullptr) {
+                Nodo* siguiente = primero->izquierdo;
+                delete primero;
+                primero = siguiente;
+            }
         }
     };
 
-    Lista<T> vertices;
-    Lista<Lista<Arista>> adyacencia;
+    static NodosLibres& nodosLibres() {
+        static NodosLibres libres = {nullptr, 0};
+        return libres;
+    }
 
-public:
-    // Constructor
-    Grafo() {}
+    static Nodo* crearNodo(const T& dato, unsigned int prioridad) {
+        NodosLibres& libres = nodosLibres();
+        if (libres.primero == nullptr) {
+            return new Nodo(dato, prioridad);
+        }
 
-    // Destructor
-    ~Grafo() {
-        vaciar();
+        Nodo* nodo = libres.primero;
+        libres.primero = nodo->izquierdo;
+        libres.cantidad--;
+        nodo->dato = dato;
+        nodo->izquierdo = nullptr;
+        nodo->derecho = nullptr;
+        nodo->tamanio = 1;
+        nodo->prioridad = prioridad;
+        nodo->referencias = 1;
+        return nodo;
     }
 
-    // Agregar vértice
-    bool agregarVertice(const T& vertice) {
-        if (existeVertice(vertice)) {
-            return false;
+    static void reciclar(Nodo* nodo) {
+        NodosLibres& libres = nodosLibres();
+        if (libres.cantidad >= MAX_NODOS_LIBRES) {
+            delete nodo;
+            return;
         }
 
-        vertices.agregar(vertice);
-        adyacencia.agregar(Lista<Arista>());
-        return true;
+        nodo->dato = T();
+        nodo->izquierdo = libres.primero;
+        libres.primero = nodo;
+        libres.cantidad++;
     }
 
-    // Verificar si existe un vértice
-    bool existeVertice(const T& vertice) const {
-        return buscarVertice(vertice) != -1;
+    static Nodo* retener(Nodo* nodo) {
+        if (nodo != nullptr) {
+            nodo->referencias++;
+        }
+        return nodo;
     }
 
-    // Buscar índice de un vértice
-    int buscarVertice(const T& vertice) const {
-        for (int i = 0; i < vertices.obtenerTamanio(); i++) {
-            if (vertices.obtener(i) == vertice) {
-                return i;
-            }
+    // Soltar una referencia y borrar los nodos que queden sin ninguna
+    static void liberar(Nodo* nodo) {
+        while (nodo != nullptr && --nodo->referencias == 0) {
+            Nodo* derecho = nodo->derecho;
+            liberar(nodo->izquierdo);
+            reciclar(nodo);
+            nodo = derecho;
         }
-        return -1;
     }
 
-    // Agregar arista
-    bool agregarArista(const T& origen, const T& destino, int peso = 1) {
-        int indiceOrigen = buscarVertice(origen);
-        int indiceDestino = buscarVertice(destino);
-
-        if (indiceOrigen == -1 || indiceDestino == -1) {
-            return false;
+    // Cambiar una referencia a un nodo por una a un nodo modificable:
+    // el mismo si nadie más lo comparte, una copia en otro caso
+    static Nodo* propio(Nodo* nodo) {
+        if (nodo->referencias == 1) {
+            return nodo;
         }
 
-        // Verificar si la arista ya existe
-        Lista<Arista> listaAdyacencia = adyacencia.obtener(indiceOrigen);
-        for (int i = 0; i < listaAdyacencia.obtenerTamanio(); i++) {
-            if (listaAdyacencia.obtener(i).destino == indiceDestino) {
-                return false;
-            }
+        Nodo* copia = crearNodo(nodo->dato, nodo->prioridad);
+        copia->izquierdo = retener(nodo->izquierdo);
+        copia->derecho = retener(nodo->derecho);
+        copia->tamanio = nodo->tamanio;
+        nodo->referencias--;
+        return copia;
+    }
+
+    // Separar los primeros k elementos; consume la referencia recibida
+    static void dividir(Nodo* nodo, int k, Nodo*& izquierda, Nodo*& derecha) {
+        if (nodo == nullptr) {
+            izquierda = derecha = nullptr;
+            return;
         }
 
-        // Agregar la arista
-        listaAdyacencia.agregar(Arista(indiceDestino, peso));
-        adyacencia.modificar(indiceOrigen, listaAdyacencia);
-        return true;
+        nodo = propio(nodo);
+        if (tamanioDe(nodo->izquierdo) < k) {
+            dividir(nodo->derecho, k - tamanioDe(nodo->izquierdo) - 1, nodo->derecho, derecha);
+            actualizar(nodo);
+            izquierda = nodo;
+        } else {
+            dividir(nodo->izquierdo, k, izquierda, nodo->izquierdo);
+            actualizar(nodo);
+            derecha = nodo;
+        }
     }
 
-    // Obtener vértices adyacentes (BFS)
-    Lista<T> obtenerVecinosBFS(const T& origen) const {
-        Lista<T> resultado;
-        int indiceOrigen = buscarVertice(origen);
-
-        if (indiceOrigen == -1) {
-            return resultado;
+    // Concatenar dos secuencias; consume ambas referencias
+    static Nodo* unir(Nodo* izquierda, Nodo* derecha) {
+        if (izquierda == nullptr) {
+            return derecha;
+        }
+        if (derecha == nullptr) {
+            return izquierda;
         }
 
-        // Arreglo para marcar vértices visitados
-        bool* visitados = new bool[vertices.obtenerTamanio()];
-        for (int i = 0; i < vertices.obtenerTamanio(); i++) {
-            visitados[i] = false;
+        if (izquierda->prioridad > derecha->prioridad) {
+            izquierda = propio(izquierda);
+            izquierda->derecho = unir(izquierda->derecho, derecha);
+            actualizar(izquierda);
+            return izquierda;
         }
 
-        // Cola para BFS
-        Cola<int> cola;
-        cola.encolar(indiceOrigen);
-        visitados[indiceOrigen] = true;
+        derecha = propio(derecha);
+        derecha->izquierdo = unir(izquierda, derecha->izquierdo);
+        actualizar(derecha);
+        return derecha;
+    }
 
-        while (!cola.estaVacia()) {
-            int actual = cola.frente();
-            cola.desencolar();
+    static void calcularTamanios(Nodo* nodo) {
+        if (nodo != nullptr) {
+            calcularTamanios(nodo->izquierdo);
+            calcularTamanios(nodo->derecho);
+            actualizar(nodo);
+        }
+    }
+
+    // Construir en O(k) el árbol de los elementos indicados, en orden, con la espina derecha como pila
+    static Nodo* construir(const Lista<T>& elementos, int desde) {
+        Lista<Nodo*> espina;
+        for (int i = desde; i < elementos.obtenerTamanio(); i++) {
+            Nodo* nodo = crearNodo(elementos.obtener(i), nuevaPrioridad());
+
+            Nodo* ultimoQuitado = nullptr;
+            while (espina.obtenerTamanio() > 0 &&
+                   espina.obtener(espina.obtenerTamanio() - 1)->prioridad < nodo->prioridad) {
+                ultimoQuitado = espina.obtener(espina.obtenerTamanio() - 1);
+                espina.eliminar(espina.obtenerTamanio() - 1);
+            }
+
+            nodo->izquierdo = ultimoQuitado;
+            if (espina.obtenerTamanio() > 0) {
+                espina.obtener(espina.obtenerTamanio() - 1)->derecho = nodo;
+            }
+            espina.agregar(nodo);
+        }
+
+        if (espina.obtenerTamanio() == 0) {
+            return nullptr;
+        }
+
+        calcularTamanios(espina.obtener(0));
+        return espina.obtener(0);
+    }
+
+public:
+    // Constructor
+    SecuenciaPersistente() : raiz(nullptr) {}
+
+    // Constructor de copia: comparte todos los nodos
+    SecuenciaPersistente(const SecuenciaPersistente& otra) : raiz(retener(otra.raiz)) {}
+
+    // Constructor de movimiento
+    SecuenciaPersistente(SecuenciaPersistente&& otra) noexcept : raiz(otra.raiz) {
+        otra.raiz = nullptr;
+    }
+
+    // Asignación por copia
+    SecuenciaPersistente& operator=(const SecuenciaPersistente& otra) {
+        Nodo* anterior = raiz;
+        raiz = retener(otra.raiz);
+        liberar(anterior);
+        return *this;
+    }
+
+    // Asignación por movimiento
+    SecuenciaPersistente& operator=(SecuenciaPersistente&& otra) noexcept {
+        if (this != &otra) {
+            liberar(raiz);
+            raiz = otra.raiz;
+            otra.raiz = nullptr;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~SecuenciaPersistente() {
+        liberar(raiz);
+    }
+
+    // Insertar elemento en la posición indicada
+    bool insertar(int posicion, const T& elemento) {
+        if (posicion < 0 || posicion > obtenerTamanio()) {
+            return false;
+        }
+
+        Nodo* izquierda;
+        Nodo* derecha;
+        dividir(raiz, posicion, izquierda, derecha);
+        raiz = unir(unir(izquierda, crearNodo(elemento, nuevaPrioridad())), derecha);
+        return true;
+    }
+
+    void agregarAlFrente(const T& elemento) {
+        insertar(0, elemento);
+    }
+
+    void agregarAlFinal(const T& elemento) {
+        insertar(obtenerTamanio(), elemento);
+    }
+
+    // Agregar al final los elementos de una lista a partir de la posición indicada, O(k + log n)
+    void agregarVarios(const Lista<T>& elementos, int desde = 0) {
+        raiz = unir(raiz, construir(elementos, std::max(0, desde)));
+    }
+
+    // Eliminar elemento en la posición indicada
+    bool eliminar(int posicion) {
+        if (posicion < 0 || posicion >= obtenerTamanio()) {
+            return false;
+        }
+
+        Nodo* izquierda;
+        Nodo* resto;
+        Nodo* elemento;
+        Nodo* derecha;
+        dividir(raiz, posicion, izquierda, resto);
+        dividir(resto, 1, elemento, derecha);
+        liberar(elemento);
+        raiz = unir(izquierda, derecha);
+        return true;
+    }
+
+    bool quitarDelFrente() {
+        return eliminar(0);
+    }
+
+    // Mover un elemento a otra posición, desplazando los que quedan entre ambas
+    bool mover(int desde, int hasta) {
+        if (desde < 0 || desde >= obtenerTamanio() || hasta < 0 || hasta >= obtenerTamanio()) {
+            return false;
+        }
+
+        T elemento = obtener(desde);
+        eliminar(desde);
+        return insertar(hasta, elemento);
+    }
+
+    // Obtener elemento por posición
+    const T& obtener(int posicion) const {
+        if (posicion < 0 || posicion >= obtenerTamanio()) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+
+        const Nodo* actual = raiz;
+        while (true) {
+            int izquierdos = tamanioDe(actual->izquierdo);
+            if (posicion < izquierdos) {
+                actual = actual->izquierdo;
+            } else if (posicion == izquierdos) {
+                return actual->dato;
+            } else {
+                posicion -= izquierdos + 1;
+                actual = actual->derecho;
+            }
+        }
+    }
+
+    const T& frente() const {
+        if (estaVacia()) {
+            throw std::out_of_range("La secuencia está vacía");
+        }
+        return obtener(0);
+    }
+
+    // Copiar los elementos en orden al final de una lista
+    void copiarEn(Lista<T>& destino) const {
+        destino.reservar(destino.obtenerTamanio() + obtenerTamanio());
+
+        Lista<const Nodo*> pendientes;
+        const Nodo* actual = raiz;
+        while (actual != nullptr || pendientes.obtenerTamanio() > 0) {
+            while (actual != nullptr) {
+                pendientes.agregar(actual);
+                actual = actual->izquierdo;
+            }
+            actual = pendientes.obtener(pendientes.obtenerTamanio() - 1);
+            pendientes.eliminar(pendientes.obtenerTamanio() - 1);
+            destino.agregar(actual->dato);
+            actual = actual->derecho;
+        }
+    }
+
+    bool estaVacia() const {
+        return raiz == nullptr;
+    }
+
+    int obtenerTamanio() const {
+        return tamanioDe(raiz);
+    }
+
+    void vaciar() {
+        liberar(raiz);
+        raiz = nullptr;
+    }
+};
+
+/**
+ * @brief Implementación de una cola de prioridad (montículo binario)
+ *
+ * El frente es siempre el mayor elemento según el comparador (por defecto operator<);
+ * con std::greater<T> el frente es el menor.
+ */
+template <typename T, typename Comparador = std::less<T>>
+class ColaPrioridad {
+private:
+    Lista<T> elementos;
+    Comparador comparador;
+
+    // Subir un elemento hasta restaurar la propiedad del montículo
+    void subir(int indice) {
+        while (indice > 0) {
+            int padre = (indice - 1) / 2;
+            if (!comparador(elementos.obtener(padre), elementos.obtener(indice))) {
+                break;
+            }
+            std::swap(elementos.obtener(padre), elementos.obtener(indice));
+            indice = padre;
+        }
+    }
+
+    // Bajar un elemento hasta restaurar la propiedad del montículo
+    void bajar(int indice) {
+        int n = elementos.obtenerTamanio();
+
+        while (true) {
+            int mayor = indice;
+            int izquierdo = 2 * indice + 1;
+            int derecho = izquierdo + 1;
+
+            if (izquierdo < n && comparador(elementos.obtener(mayor), elementos.obtener(izquierdo))) {
+                mayor = izquierdo;
+            }
+            if (derecho < n && comparador(elementos.obtener(mayor), elementos.obtener(derecho))) {
+                mayor = derecho;
+            }
+            if (mayor == indice) {
+                break;
+            }
+
+            std::swap(elementos.obtener(indice), elementos.obtener(mayor));
+            indice = mayor;
+        }
+    }
+
+public:
+    // Encolar elemento
+    void encolar(const T& elemento) {
+        elementos.agregar(elemento);
+        subir(elementos.obtenerTamanio() - 1);
+    }
+
+    // Encolar sin superar la capacidad: si está llena, el elemento solo entra
+    // desplazando al frente cuando queda por detrás de él según el comparador.
+    // Con std::greater<T> conserva así los mayores elementos vistos (top-k)
+    bool encolarAcotado(const T& elemento, int capacidad) {
+        if (elementos.obtenerTamanio() < capacidad) {
+            encolar(elemento);
+            return true;
+        }
+        if (capacidad <= 0 || !comparador(elemento, frente())) {
+            return false;
+        }
+
+        elementos.obtener(0) = elemento;
+        bajar(0);
+        return true;
+    }
+
+    // Desencolar el elemento de mayor prioridad
+    bool desencolar() {
+        if (estaVacia()) {
+            return false;
+        }
+
+        int ultimo = elementos.obtenerTamanio() - 1;
+        std::swap(elementos.obtener(0), elementos.obtener(ultimo));
+        elementos.eliminar(ultimo);
+
+        if (!estaVacia()) {
+            bajar(0);
+        }
+        return true;
+    }
+
+    // Obtener el elemento de mayor prioridad
+    const T& frente() const {
+        if (estaVacia()) {
+            throw std::out_of_range("La cola de prioridad está vacía");
+        }
+        return elementos.obtener(0);
+    }
+
+    // Verificar si la cola de prioridad está vacía
+    bool estaVacia() const {
+        return elementos.estaVacia();
+    }
+
+    // Obtener tamaño de la cola de prioridad
+    int obtenerTamanio() const {
+        return elementos.obtenerTamanio();
+    }
+
+    // Vaciar la cola de prioridad
+    void vaciar() {
+        elementos.vaciar();
+    }
+};
+
+/**
+ * @brief Funciones de dispersión para las tablas hash
+ */
+template <typename T>
+struct FuncionHash;
+
+template <>
+struct FuncionHash<int> {
+    static uint32_t calcular(int valor) {
+        uint32_t x = static_cast<uint32_t>(valor);
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+};
+
+template <>
+struct FuncionHash<std::string> {
+    // FNV-1a de 32 bits sobre una secuencia de bytes
+    static uint32_t calcularBytes(const char* datos, int longitud) {
+        uint32_t hash = 2166136261U;
+        for (int i = 0; i < longitud; i++) {
+            hash ^= static_cast<unsigned char>(datos[i]);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
+    static uint32_t calcular(const std::string& valor) {
+        return calcularBytes(valor.data(), static_cast<int>(valor.length()));
+    }
+};
+
+/**
+ * @brief Implementación de una tabla hash con direccionamiento abierto (sondeo lineal)
+ */
+template <typename K, typename V>
+class TablaHash {
+private:
+    struct Entrada {
+        K clave;
+        V valor;
+        bool ocupada;
+
+        Entrada() : clave(), valor(), ocupada(false) {}
+    };
+
+    Entrada* entradas;
+    int capacidad;   // Siempre potencia de dos
+    int tamanio;
+
+    // Posición donde está la clave, o la primera libre de su secuencia de sondeo
+    int buscarPosicion(const K& clave) const {
+        int mascara = capacidad - 1;
+        int posicion = static_cast<int>(FuncionHash<K>::calcular(clave) & static_cast<uint32_t>(mascara));
+
+        while (entradas[posicion].ocupada && !(entradas[posicion].clave == clave)) {
+            posicion = (posicion + 1) & mascara;
+        }
+        return posicion;
+    }
+
+    // Cambiar la capacidad y reubicar todas las entradas
+    void redimensionar(int nuevaCapacidad) {
+        Entrada* anteriores = entradas;
+        int capacidadAnterior = capacidad;
+
+        entradas = new Entrada[nuevaCapacidad];
+        capacidad = nuevaCapacidad;
+
+        for (int i = 0; i < capacidadAnterior; i++) {
+            if (anteriores[i].ocupada) {
+                Entrada& destino = entradas[buscarPosicion(anteriores[i].clave)];
+                destino.clave = std::move(anteriores[i].clave);
+                destino.valor = std::move(anteriores[i].valor);
+                destino.ocupada = true;
+            }
+        }
+
+        delete[] anteriores;
+    }
+
+public:
+    // Constructor
+    TablaHash() : entradas(nullptr), capacidad(0), tamanio(0) {}
+
+    // Constructor de copia
+    TablaHash(const TablaHash& otra) : entradas(nullptr), capacidad(otra.capacidad), tamanio(otra.tamanio) {
+        if (capacidad > 0) {
+            entradas = new Entrada[capacidad];
+            for (int i = 0; i < capacidad; i++) {
+                entradas[i] = otra.entradas[i];
+            }
+        }
+    }
+
+    // Constructor de movimiento
+    TablaHash(TablaHash&& otra) noexcept : entradas(otra.entradas), capacidad(otra.capacidad), tamanio(otra.tamanio) {
+        otra.entradas = nullptr;
+        otra.capacidad = 0;
+        otra.tamanio = 0;
+    }
+
+    // Asignación por copia
+    TablaHash& operator=(const TablaHash& otra) {
+        if (this != &otra) {
+            TablaHash copia(otra);
+            *this = std::move(copia);
+        }
+        return *this;
+    }
+
+    // Asignación por movimiento
+    TablaHash& operator=(TablaHash&& otra) noexcept {
+        if (this != &otra) {
+            delete[] entradas;
+            entradas = otra.entradas;
+            capacidad = otra.capacidad;
+            tamanio = otra.tamanio;
+            otra.entradas = nullptr;
+            otra.capacidad = 0;
+            otra.tamanio = 0;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~TablaHash() {
+        delete[] entradas;
+    }
+
+    // Insertar o actualizar el valor asociado a una clave
+    void insertar(const K& clave, const V& valor) {
+        // Mantener el factor de carga por debajo de 1/2
+        if ((tamanio + 1) * 2 > capacidad) {
+            redimensionar(capacidad == 0 ? 16 : capacidad * 2);
+        }
+
+        Entrada& entrada = entradas[buscarPosicion(clave)];
+        if (!entrada.ocupada) {
+            entrada.clave = clave;
+            entrada.ocupada = true;
+            tamanio++;
+        }
+        entrada.valor = valor;
+    }
+
+    // Buscar el valor asociado a una clave (nullptr si no existe)
+    V* buscar(const K& clave) {
+        if (tamanio == 0) {
+            return nullptr;
+        }
+
+        Entrada& entrada = entradas[buscarPosicion(clave)];
+        return entrada.ocupada ? &entrada.valor : nullptr;
+    }
+
+    const V* buscar(const K& clave) const {
+        if (tamanio == 0) {
+            return nullptr;
+        }
+
+        const Entrada& entrada = entradas[buscarPosicion(clave)];
+        return entrada.ocupada ? &entrada.valor : nullptr;
+    }
+
+    // Verificar si la tabla contiene una clave
+    bool contiene(const K& clave) const {
+        return buscar(clave) != nullptr;
+    }
+
+    // Obtener número de claves
+    int obtenerTamanio() const {
+        return tamanio;
+    }
+
+    // Verificar si la tabla está vacía
+    bool estaVacia() const {
+        return tamanio == 0;
+    }
+
+    // Vaciar la tabla
+    void vaciar() {
+        delete[] entradas;
+        entradas = nullptr;
+        capacidad = 0;
+        tamanio = 0;
+    }
+};
+
+/**
+ * @brief Conjunto de enteros en [0, n) con un valor asociado, vaciable en O(1)
+ *
+ * Cada entrada guarda la época en que se marcó; empezar una época nueva invalida todas
+ * las marcas anteriores sin recorrer el arreglo ni liberar memoria.
+ */
+class MarcasEpoca {
+private:
+    Lista<unsigned int> marcas;
+    Lista<int> valores;
+    unsigned int epoca;
+
+public:
+    // Constructor
+    MarcasEpoca() : epoca(0) {}
+
+    // Empezar una época nueva con capacidad para n elementos
+    void reiniciar(int n) {
+        while (marcas.obtenerTamanio() < n) {
+            marcas.agregar(0);
+            valores.agregar(0);
+        }
+
+        epoca++;
+        if (epoca == 0) {
+            // Desbordamiento del contador: limpiar las marcas una vez
+            for (unsigned int& marca : marcas) {
+                marca = 0;
+            }
+            epoca = 1;
+        }
+    }
+
+    // Verificar si un elemento está marcado en la época actual
+    bool contiene(int elemento) const {
+        return marcas.obtener(elemento) == epoca;
+    }
+
+    // Marcar un elemento y asociarle un valor
+    void marcar(int elemento, int valor = 0) {
+        marcas.obtener(elemento) = epoca;
+        valores.obtener(elemento) = valor;
+    }
+
+    // Obtener el valor asociado a un elemento marcado
+    int obtenerValor(int elemento) const {
+        return valores.obtener(elemento);
+    }
+};
+
+/**
+ * @brief Conjunto comprimido de enteros no negativos (estilo roaring)
+ *
+ * Los valores se reparten en bloques según sus 16 bits altos. Un bloque guarda los 16
+ * bits bajos en un arreglo ordenado mientras tiene hasta 4096 elementos, y a partir de
+ * ahí en un mapa de 65536 bits (1024 palabras de 64 bits), que entonces ocupa menos.
+ * Las operaciones de conjuntos combinan los mapas de bits palabra a palabra y solo
+ * mezclan elemento a elemento cuando ambos bloques son arreglos.
+ */
+class MapaBits {
+private:
+    static const int MAXIMO_ARREGLO = 4096;
+    static const int PALABRAS_BLOQUE = 1024;
+
+    struct Bloque {
+        int clave;                  // 16 bits altos de los valores
+        int cardinalidad;
+        Lista<uint16_t> valores;    // Bloque de arreglo: 16 bits bajos en orden creciente
+        Lista<uint64_t> palabras;   // Bloque de mapa: PALABRAS_BLOQUE palabras (vacío si es arreglo)
+
+        explicit Bloque(int _clave = 0) : clave(_clave), cardinalidad(0) {}
+
+        bool esMapa() const {
+            return !palabras.estaVacia();
+        }
+    };
+
+    // Operaciones entre bloques
+    enum Operacion {
+        INTERSECCION,
+        UNION,
+        DIFERENCIA
+    };
+
+    Lista<Bloque> bloques;   // En orden creciente de clave
+
+    // Posición del bloque con la clave, o -(posición de inserción) - 1 si no existe
+    int buscarBloque(int clave) const {
+        int inicio = 0;
+        int fin = bloques.obtenerTamanio() - 1;
+        while (inicio <= fin) {
+            int medio = inicio + (fin - inicio) / 2;
+            int actual = bloques.obtener(medio).clave;
+            if (actual == clave) {
+                return medio;
+            }
+            if (actual < clave) {
+                inicio = medio + 1;
+            } else {
+                fin = medio - 1;
+            }
+        }
+        return -inicio - 1;
+    }
+
+    // Primera posición del arreglo con un valor >= el dado
+    static int buscarEnArreglo(const Lista<uint16_t>& valores, uint16_t valor) {
+        int inicio = 0;
+        int fin = valores.obtenerTamanio();
+        while (inicio < fin) {
+            int medio = inicio + (fin - inicio) / 2;
+            if (valores.obtener(medio) < valor) {
+                inicio = medio + 1;
+            } else {
+                fin = medio;
+            }
+        }
+        return inicio;
+    }
+
+    // Pasar un bloque de arreglo a mapa de bits
+    static void convertirEnMapa(Bloque& bloque) {
+        bloque.palabras.reservar(PALABRAS_BLOQUE);
+        for (int i = 0; i < PALABRAS_BLOQUE; i++) {
+            bloque.palabras.agregar(0);
+        }
+        for (uint16_t valor : bloque.valores) {
+            bloque.palabras.obtener(valor >> 6) |= 1ull << (valor & 63);
+        }
+        bloque.valores = Lista<uint16_t>();
+    }
+
+    // Pasar un bloque de mapa de bits a arreglo
+    static void convertirEnArreglo(Bloque& bloque) {
+        bloque.valores.vaciar();
+        bloque.valores.reservar(bloque.cardinalidad);
+        for (int i = 0; i < PALABRAS_BLOQUE; i++) {
+            uint64_t palabra = bloque.palabras.obtener(i);
+            while (palabra != 0) {
+                bloque.valores.agregar(static_cast<uint16_t>(i * 64 + bitMasBajo(palabra)));
+                palabra &= palabra - 1;
+            }
+        }
+        bloque.palabras = Lista<uint64_t>();
+    }
+
+    // Escribir un bloque como mapa de bits en un arreglo de PALABRAS_BLOQUE palabras
+    static void expandir(const Bloque& bloque, uint64_t* destino) {
+        if (bloque.esMapa()) {
+            std::memcpy(destino, bloque.palabras.begin(), sizeof(uint64_t) * PALABRAS_BLOQUE);
+            return;
+        }
+        std::memset(destino, 0, sizeof(uint64_t) * PALABRAS_BLOQUE);
+        for (uint16_t valor : bloque.valores) {
+            destino[valor >> 6] |= 1ull << (valor & 63);
+        }
+    }
+
+    // Combinar dos bloques con la misma clave; devuelve false si el resultado queda vacío
+    static bool combinarBloques(const Bloque& a, const Bloque& b, Operacion operacion, Bloque& resultado) {
+        resultado.clave = a.clave;
+        resultado.cardinalidad = 0;
+
+        if (!a.esMapa() && !b.esMapa()) {
+            // Dos arreglos: mezcla ordenada
+            int i = 0;
+            int j = 0;
+            int n = a.valores.obtenerTamanio();
+            int m = b.valores.obtenerTamanio();
+            const uint16_t* x = a.valores.begin();
+            const uint16_t* y = b.valores.begin();
+
+            while (i < n || j < m) {
+                if (j == m || (i < n && x[i] < y[j])) {
+                    if (operacion != INTERSECCION) {
+                        resultado.valores.agregar(x[i]);
+                    }
+                    i++;
+                } else if (i == n || y[j] < x[i]) {
+                    if (operacion == UNION) {
+                        resultado.valores.agregar(y[j]);
+                    }
+                    j++;
+                } else {
+                    if (operacion != DIFERENCIA) {
+                        resultado.valores.agregar(x[i]);
+                    }
+                    i++;
+                    j++;
+                }
+            }
+
+            resultado.cardinalidad = resultado.valores.obtenerTamanio();
+            if (resultado.cardinalidad > MAXIMO_ARREGLO) {
+                convertirEnMapa(resultado);
+            }
+            return resultado.cardinalidad > 0;
+        }
+
+        // Algún mapa de bits: operar palabra a palabra
+        uint64_t otro[PALABRAS_BLOQUE];
+        expandir(b, otro);
+        resultado.palabras.reservar(PALABRAS_BLOQUE);
+        for (int i = 0; i < PALABRAS_BLOQUE; i++) {
+            resultado.palabras.agregar(0);
+        }
+        expandir(a, resultado.palabras.begin());
+
+        uint64_t* palabras = resultado.palabras.begin();
+        for (int i = 0; i < PALABRAS_BLOQUE; i++) {
+            switch (operacion) {
+                case INTERSECCION: palabras[i] &= otro[i]; break;
+                case UNION: palabras[i] |= otro[i]; break;
+                case DIFERENCIA: palabras[i] &= ~otro[i]; break;
+            }
+            resultado.cardinalidad += contarBits(palabras[i]);
+        }
+
+        if (resultado.cardinalidad <= MAXIMO_ARREGLO) {
+            convertirEnArreglo(resultado);
+        }
+        return resultado.cardinalidad > 0;
+    }
+
+    // Aplicar una operación de conjuntos a dos mapas
+    static MapaBits combinar(const MapaBits& a, const MapaBits& b, Operacion operacion) {
+        MapaBits resultado;
+        int i = 0;
+        int j = 0;
+        int n = a.bloques.obtenerTamanio();
+        int m = b.bloques.obtenerTamanio();
+
+        while (i < n || j < m) {
+            if (j == m || (i < n && a.bloques.obtener(i).clave < b.bloques.obtener(j).clave)) {
+                if (operacion != INTERSECCION) {
+                    resultado.bloques.agregar(a.bloques.obtener(i));
+                }
+                i++;
+            } else if (i == n || b.bloques.obtener(j).clave < a.bloques.obtener(i).clave) {
+                if (operacion == UNION) {
+                    resultado.bloques.agregar(b.bloques.obtener(j));
+                }
+                j++;
+            } else {
+                Bloque bloque;
+                if (combinarBloques(a.bloques.obtener(i), b.bloques.obtener(j), operacion, bloque)) {
+                    resultado.bloques.agregar(std::move(bloque));
+                }
+                i++;
+                j++;
+            }
+        }
+
+        return resultado;
+    }
+
+public:
+    // Contar los bits a 1 de una palabra
+    static int contarBits(uint64_t palabra) {
+#if defined(__GNUC__)
+        return __builtin_popcountll(palabra);
+#else
+        int total = 0;
+        while (palabra != 0) {
+            palabra &= palabra - 1;
+            total++;
+        }
+        return total;
+#endif
+    }
+
+    // Posición del bit a 1 más bajo de una palabra distinta de cero
+    static int bitMasBajo(uint64_t palabra) {
+#if defined(__GNUC__)
+        return __builtin_ctzll(palabra);
+#else
+        int posicion = 0;
+        while ((palabra & 1) == 0) {
+            palabra >>= 1;
+            posicion++;
+        }
+        return posicion;
+#endif
+    }
+
+    // Agregar un valor (agregar en orden creciente es O(1))
+    void agregar(int valor) {
+        int clave = valor >> 16;
+        uint16_t bajo = static_cast<uint16_t>(valor & 0xFFFF);
+
+        int posicion = !bloques.estaVacia() && bloques.obtener(bloques.obtenerTamanio() - 1).clave == clave
+                           ? bloques.obtenerTamanio() - 1
+                           : buscarBloque(clave);
+        if (posicion < 0) {
+            posicion = -posicion - 1;
+            bloques.insertar(posicion, Bloque(clave));
+        }
+
+        Bloque& bloque = bloques.obtener(posicion);
+        if (bloque.esMapa()) {
+            uint64_t& palabra = bloque.palabras.obtener(bajo >> 6);
+            uint64_t bit = 1ull << (bajo & 63);
+            if ((palabra & bit) == 0) {
+                palabra |= bit;
+                bloque.cardinalidad++;
+            }
+            return;
+        }
+
+        Lista<uint16_t>& valores = bloque.valores;
+        if (valores.estaVacia() || valores.obtener(valores.obtenerTamanio() - 1) < bajo) {
+            valores.agregar(bajo);
+        } else {
+            int indice = buscarEnArreglo(valores, bajo);
+            if (valores.obtener(indice) == bajo) {
+                return;
+            }
+            valores.insertar(indice, bajo);
+        }
+
+        bloque.cardinalidad++;
+        if (bloque.cardinalidad > MAXIMO_ARREGLO) {
+            convertirEnMapa(bloque);
+        }
+    }
+
+    // Eliminar un valor; devuelve false si no estaba
+    bool eliminar(int valor) {
+        int posicion = buscarBloque(valor >> 16);
+        if (posicion < 0) {
+            return false;
+        }
+
+        Bloque& bloque = bloques.obtener(posicion);
+        uint16_t bajo = static_cast<uint16_t>(valor & 0xFFFF);
+
+        if (bloque.esMapa()) {
+            uint64_t& palabra = bloque.palabras.obtener(bajo >> 6);
+            uint64_t bit = 1ull << (bajo & 63);
+            if ((palabra & bit) == 0) {
+                return false;
+            }
+            palabra &= ~bit;
+            if (--bloque.cardinalidad <= MAXIMO_ARREGLO) {
+                convertirEnArreglo(bloque);
+            }
+        } else {
+            int indice = buscarEnArreglo(bloque.valores, bajo);
+            if (indice == bloque.valores.obtenerTamanio() || bloque.valores.obtener(indice) != bajo) {
+                return false;
+            }
+            bloque.valores.eliminar(indice);
+            bloque.cardinalidad--;
+        }
+
+        if (bloque.cardinalidad == 0) {
+            bloques.eliminar(posicion);
+        }
+        return true;
+    }
+
+    // Verificar si contiene un valor
+    bool contiene(int valor) const {
+        int posicion = buscarBloque(valor >> 16);
+        if (posicion < 0) {
+            return false;
+        }
+
+        const Bloque& bloque = bloques.obtener(posicion);
+        uint16_t bajo = static_cast<uint16_t>(valor & 0xFFFF);
+        if (bloque.esMapa()) {
+            return (bloque.palabras.obtener(bajo >> 6) >> (bajo & 63)) & 1;
+        }
+
+        int indice = buscarEnArreglo(bloque.valores, bajo);
+        return indice < bloque.valores.obtenerTamanio() && bloque.valores.obtener(indice) == bajo;
+    }
+
+    // Número de valores del conjunto
+    int cardinalidad() const {
+        int total = 0;
+        for (const Bloque& bloque : bloques) {
+            total += bloque.cardinalidad;
+        }
+        return total;
+    }
+
+    bool estaVacio() const {
+        return bloques.estaVacia();
+    }
+
+    // Operaciones de conjuntos
+    static MapaBits interseccion(const MapaBits& a, const MapaBits& b) {
+        return combinar(a, b, INTERSECCION);
+    }
+
+    static MapaBits unir(const MapaBits& a, const MapaBits& b) {
+        return combinar(a, b, UNION);
+    }
+
+    // Valores de a que no están en b
+    static MapaBits diferencia(const MapaBits& a, const MapaBits& b) {
+        return combinar(a, b, DIFERENCIA);
+    }
+
+    // Tamaño de la intersección sin construirla
+    static int cardinalidadInterseccion(const MapaBits& a, const MapaBits& b) {
+        int total = 0;
+        int i = 0;
+        int j = 0;
+
+        while (i < a.bloques.obtenerTamanio() && j < b.bloques.obtenerTamanio()) {
+            const Bloque& x = a.bloques.obtener(i);
+            const Bloque& y = b.bloques.obtener(j);
+            if (x.clave < y.clave) {
+                i++;
+                continue;
+            }
+            if (y.clave < x.clave) {
+                j++;
+                continue;
+            }
+
+            if (x.esMapa() && y.esMapa()) {
+                for (int k = 0; k < PALABRAS_BLOQUE; k++) {
+                    total += contarBits(x.palabras.obtener(k) & y.palabras.obtener(k));
+                }
+            } else if (x.esMapa() || y.esMapa()) {
+                const Bloque& mapa = x.esMapa() ? x : y;
+                const Bloque& arreglo = x.esMapa() ? y : x;
+                for (uint16_t valor : arreglo.valores) {
+                    total += (mapa.palabras.obtener(valor >> 6) >> (valor & 63)) & 1;
+                }
+            } else {
+                int p = 0;
+                int q = 0;
+                while (p < x.valores.obtenerTamanio() && q < y.valores.obtenerTamanio()) {
+                    uint16_t u = x.valores.obtener(p);
+                    uint16_t v = y.valores.obtener(q);
+                    if (u == v) {
+                        total++;
+                    }
+                    p += u <= v;
+                    q += v <= u;
+                }
+            }
+            i++;
+            j++;
+        }
+
+        return total;
+    }
+
+    // Agregar a la lista los valores en orden creciente
+    void obtenerValores(Lista<int>& resultado) const {
+        resultado.reservar(resultado.obtenerTamanio() + cardinalidad());
+        for (const Bloque& bloque : bloques) {
+            int base = bloque.clave << 16;
+            if (bloque.esMapa()) {
+                for (int i = 0; i < PALABRAS_BLOQUE; i++) {
+                    uint64_t palabra = bloque.palabras.obtener(i);
+                    while (palabra != 0) {
+                        resultado.agregar(base + i * 64 + bitMasBajo(palabra));
+                        palabra &= palabra - 1;
+                    }
+                }
+            } else {
+                for (uint16_t valor : bloque.valores) {
+                    resultado.agregar(base + valor);
+                }
+            }
+        }
+    }
+
+    // Vaciar el conjunto
+    void vaciar() {
+        bloques.vaciar();
+    }
+};
+
+/**
+ * @brief Implementación de un grafo dirigido
+ *
+ * Mientras se construye, cada vértice tiene su propia lista de aristas. Al congelarlo,
+ * las aristas se compactan en formato CSR: un arreglo de desplazamientos por vértice y
+ * un único arreglo contiguo de aristas, que los recorridos leen sin reservar memoria.
+ * Modificar un grafo congelado lo vuelve a expandir automáticamente (salvo los cambios de
+ * peso de aristas existentes, que se aplican sobre el CSR), y la siguiente consulta de
+ * aristas o recorrido lo vuelve a compactar.
+ *
+ * Los recorridos son iterativos y reutilizan su memoria de trabajo entre llamadas.
+ */
+template <typename T>
+class Grafo {
+public:
+    struct Arista {
+        int destino;
+        int peso;
+
+        Arista(int _destino, int _peso = 1) : destino(_destino), peso(_peso) {}
+
+        bool operator==(const Arista& otra) const {
+            return destino == otra.destino && peso == otra.peso;
+        }
+    };
+
+    // Vértice alcanzado por un recorrido ponderado y su puntuación acumulada
+    struct VerticePuntuado {
+        int vertice;
+        double puntuacion;
+
+        VerticePuntuado(int _vertice, double _puntuacion) : vertice(_vertice), puntuacion(_puntuacion) {}
+
+        bool operator<(const VerticePuntuado& otro) const {
+            return puntuacion < otro.puntuacion;
+        }
+
+        bool operator>(const VerticePuntuado& otro) const {
+            return puntuacion > otro.puntuacion;
+        }
+    };
+
+    // Rango contiguo con las aristas salientes de un vértice
+    struct RangoAristas {
+        const Arista* inicio;
+        const Arista* fin;
+
+        const Arista* begin() const {
+            return inicio;
+        }
+
+        const Arista* end() const {
+            return fin;
+        }
+
+        int obtenerTamanio() const {
+            return static_cast<int>(fin - inicio);
+        }
+    };
+
+private:
+    Lista<T> vertices;
+    TablaHash<T, int> identificadores;   // Vértice -> posición en vertices
+
+    // Representación de las aristas: cambia al congelar o descongelar, no el contenido,
+    // por eso las consultas constantes pueden compactarla
+    mutable Lista<Lista<Arista>> adyacencia;   // Aristas por vértice mientras se modifica
+    mutable bool congelado;
+    mutable Lista<int> desplazamientos;        // CSR: aristas de v en [desplazamientos[v], desplazamientos[v + 1])
+    mutable Lista<Arista> aristas;
+
+    // Marco de la pila explícita del DFS: vértice y siguiente arista por explorar
+    struct MarcoDFS {
+        int vertice;
+        int arista;
+
+        MarcoDFS(int _vertice, int _arista) : vertice(_vertice), arista(_arista) {}
+    };
+
+    // Memoria de trabajo de los recorridos
+    mutable MarcasEpoca visitados;
+    mutable MarcasEpoca visitadosNivel;
+    mutable Lista<int> pendientes;
+    mutable Lista<MarcoDFS> pilaDFS;
+    mutable Lista<VerticePuntuado> frontera;
+    mutable Lista<VerticePuntuado> alcanzados;
+    mutable ColaPrioridad<VerticePuntuado, std::greater<VerticePuntuado>> mejoresNivel;
+
+public:
+    // Constructor
+    Grafo() : congelado(false) {}
+
+    // Destructor
+    ~Grafo() {
+        vaciar();
+    }
+
+    // Agregar vértice
+    bool agregarVertice(const T& vertice) {
+        if (existeVertice(vertice)) {
+            return false;
+        }
+
+        agregarVerticeSiNoExiste(vertice);
+        return true;
+    }
+
+    // Agregar vértice si aún no existe y devolver su identificador
+    int agregarVerticeSiNoExiste(const T& vertice) {
+        const int* existente = identificadores.buscar(vertice);
+        if (existente) {
+            return *existente;
+        }
+
+        descongelar();
+
+        int id = vertices.obtenerTamanio();
+        vertices.agregar(vertice);
+        identificadores.insertar(vertice, id);
+        adyacencia.emplazar();
+        return id;
+    }
+
+    // Obtener el vértice con un identificador
+    const T& obtenerVertice(int id) const {
+        return vertices.obtener(id);
+    }
+
+    // Verificar si existe un vértice
+    bool existeVertice(const T& vertice) const {
+        return buscarVertice(vertice) != -1;
+    }
+
+    // Buscar índice de un vértice
+    int buscarVertice(const T& vertice) const {
+        const int* id = identificadores.buscar(vertice);
+        return id ? *id : -1;
+    }
+
+    // Agregar arista
+    bool agregarArista(const T& origen, const T& destino, int peso = 1) {
+        return agregarAristaPorId(buscarVertice(origen), buscarVertice(destino), peso);
+    }
+
+    // Agregar arista entre identificadores de vértice
+    bool agregarAristaPorId(int indiceOrigen, int indiceDestino, int peso = 1) {
+        if (indiceOrigen < 0 || indiceOrigen >= vertices.obtenerTamanio() ||
+            indiceDestino < 0 || indiceDestino >= vertices.obtenerTamanio()) {
+            return false;
+        }
+
+        descongelar();
+
+        // Verificar si la arista ya existe
+        Lista<Arista>& listaAdyacencia = adyacencia.obtener(indiceOrigen);
+        for (const Arista& arista : listaAdyacencia) {
+            if (arista.destino == indiceDestino) {
+                return false;
+            }
+        }
+
+        // Agregar la arista
+        listaAdyacencia.emplazar(indiceDestino, peso);
+        return true;
+    }
+
+    // Agregar una arista que el llamador garantiza que aún no existe (sin recorrer la lista)
+    void agregarAristaSinVerificar(int indiceOrigen, int indiceDestino, int peso = 1) {
+        descongelar();
+        adyacencia.obtener(indiceOrigen).emplazar(indiceDestino, peso);
+    }
+
+    // Eliminar la arista entre dos identificadores de vértice
+    bool eliminarAristaPorId(int indiceOrigen, int indiceDestino) {
+        if (indiceOrigen < 0 || indiceOrigen >= vertices.obtenerTamanio()) {
+            return false;
+        }
+
+        descongelar();
+
+        Lista<Arista>& listaAdyacencia = adyacencia.obtener(indiceOrigen);
+        for (int i = 0; i < listaAdyacencia.obtenerTamanio(); i++) {
+            if (listaAdyacencia.obtener(i).destino == indiceDestino) {
+                listaAdyacencia.eliminar(i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sumar al peso de una arista: la crea si no existe y la elimina si el peso llega a cero
+    // Devuelve el peso resultante
+    int ajustarPesoArista(int indiceOrigen, int indiceDestino, int delta) {
+        if (indiceOrigen < 0 || indiceOrigen >= vertices.obtenerTamanio() ||
+            indiceDestino < 0 || indiceDestino >= vertices.obtenerTamanio()) {
+            return 0;
+        }
+
+        // Si la arista existe y conserva peso positivo, basta con corregirla en el CSR
+        if (congelado) {
+            Arista* inicio = aristas.begin() + desplazamientos.obtener(indiceOrigen);
+            Arista* fin = aristas.begin() + desplazamientos.obtener(indiceOrigen + 1);
+            for (Arista* arista = inicio; arista != fin; ++arista) {
+                if (arista->destino == indiceDestino && arista->peso + delta > 0) {
+                    arista->peso += delta;
+                    return arista->peso;
+                }
+            }
+        }
+
+        descongelar();
+
+        Lista<Arista>& listaAdyacencia = adyacencia.obtener(indiceOrigen);
+        for (int i = 0; i < listaAdyacencia.obtenerTamanio(); i++) {
+            Arista& arista = listaAdyacencia.obtener(i);
+            if (arista.destino == indiceDestino) {
+                arista.peso += delta;
+                if (arista.peso > 0) {
+                    return arista.peso;
+                }
+                listaAdyacencia.eliminar(i);
+                return 0;
+            }
+        }
+
+        if (delta > 0) {
+            listaAdyacencia.emplazar(indiceDestino, delta);
+            return delta;
+        }
+        return 0;
+    }
+
+    // Obtener las aristas salientes de un vértice sin copiarlas
+    // Compacta el grafo si quedó expandido por una modificación; el rango deja de ser
+    // válido al modificar el grafo
+    RangoAristas obtenerAristas(int id) const {
+        congelar();
+        return rangoCongelado(id);
+    }
+
+    // Compactar las listas de adyacencia en formato CSR
+    void congelar() const {
+        if (congelado) {
+            return;
+        }
+
+        int total = 0;
+        for (const Lista<Arista>& lista : adyacencia) {
+            total += lista.obtenerTamanio();
+        }
+
+        desplazamientos.vaciar();
+        desplazamientos.reservar(vertices.obtenerTamanio() + 1);
+        aristas.vaciar();
+        aristas.reservar(total);
+
+        for (const Lista<Arista>& lista : adyacencia) {
+            desplazamientos.agregar(aristas.obtenerTamanio());
+            for (const Arista& arista : lista) {
+                aristas.agregar(arista);
+            }
+        }
+        desplazamientos.agregar(aristas.obtenerTamanio());
+
+        adyacencia = Lista<Lista<Arista>>();
+        congelado = true;
+    }
+
+    // Volver a las listas de adyacencia para poder modificar el grafo
+    void descongelar() {
+        if (!congelado) {
+            return;
+        }
+
+        adyacencia.vaciar();
+        adyacencia.reservar(vertices.obtenerTamanio());
+
+        for (int v = 0; v < vertices.obtenerTamanio(); v++) {
+            Lista<Arista>& lista = adyacencia.emplazar();
+            RangoAristas rango = rangoCongelado(v);
+            lista.reservar(rango.obtenerTamanio());
+            for (const Arista& arista : rango) {
+                lista.agregar(arista);
+            }
+        }
+
+        congelado = false;
+        desplazamientos = Lista<int>();
+        aristas = Lista<Arista>();
+    }
+
+    // Verificar si el grafo está compactado
+    bool estaCongelado() const {
+        return congelado;
+    }
+
+    // Puntuar los vértices a como mucho profundidadMaxima saltos del origen
+    // Cada vértice reparte su puntuación entre sus aristas en proporción al peso, atenuada en
+    // cada salto; la puntuación de un vértice suma todos los caminos que llegan a él.
+    // En cada nivel solo se expanden los anchoHaz vértices con más puntuación, así que el
+    // coste depende de la profundidad y del haz, no del tamaño del grafo.
+    // El resultado se escribe en la lista recibida para poder reutilizar su memoria
+    void obtenerVecinosPonderados(int origen, int profundidadMaxima, int anchoHaz,
+                                  Lista<VerticePuntuado>& resultado, double atenuacion = 0.5) const {
+        resultado.vaciar();
+        if (origen < 0 || origen >= vertices.obtenerTamanio()) {
+            return;
+        }
+
+        congelar();
+
+        // visitados: posición de cada vértice en resultado
+        visitados.reiniciar(vertices.obtenerTamanio());
+        frontera.vaciar();
+        frontera.emplazar(origen, 1.0);
+
+        for (int nivel = 0; nivel < profundidadMaxima && !frontera.estaVacia(); nivel++) {
+            // visitadosNivel: posición de cada vértice en alcanzados
+            visitadosNivel.reiniciar(vertices.obtenerTamanio());
+            alcanzados.vaciar();
+
+            for (const VerticePuntuado& actual : frontera) {
+                RangoAristas rango = rangoCongelado(actual.vertice);
+                int pesoTotal = 0;
+                for (const Arista& arista : rango) {
+                    pesoTotal += arista.peso;
+                }
+
+                for (const Arista& arista : rango) {
+                    if (arista.destino != origen) {
+                        double aporte = actual.puntuacion * atenuacion * arista.peso / pesoTotal;
+                        acumularPuntuacion(alcanzados, visitadosNivel, arista.destino, aporte);
+                    }
+                }
+            }
+
+            for (const VerticePuntuado& alcanzado : alcanzados) {
+                acumularPuntuacion(resultado, visitados, alcanzado.vertice, alcanzado.puntuacion);
+            }
+
+            // Poda: solo los mejores del nivel continúan el recorrido
+            frontera.vaciar();
+            if (alcanzados.obtenerTamanio() <= anchoHaz) {
+                for (const VerticePuntuado& alcanzado : alcanzados) {
+                    frontera.agregar(alcanzado);
+                }
+            } else {
+                mejoresNivel.vaciar();
+                for (const VerticePuntuado& alcanzado : alcanzados) {
+                    mejoresNivel.encolarAcotado(alcanzado, anchoHaz);
+                }
+                while (!mejoresNivel.estaVacia()) {
+                    frontera.agregar(mejoresNivel.frente());
+                    mejoresNivel.desencolar();
+                }
+            }
+        }
+    }
+
+    // PageRank personalizado (paseo aleatorio con reinicio)
+    // En cada paso el paseante vuelve a las semillas con probabilidadReinicio o sigue una
+    // arista elegida en proporción a su peso; los vértices sin aristas devuelven su masa
+    // a las semillas. Solo se recorren los vértices con masa, y se itera hasta que el cambio
+    // (norma L1) baja de la tolerancia o se alcanza maxIteraciones.
+    // Las semillas deben sumar 1; el resultado queda en la lista recibida
+    void calcularPageRankPersonalizado(const Lista<VerticePuntuado>& semillas, double probabilidadReinicio,
+                                       double tolerancia, int maxIteraciones,
+                                       Lista<VerticePuntuado>& resultado) const {
+        resultado.vaciar();
+        congelar();
+
+        // frontera: distribución actual, con sus posiciones en visitados
+        visitados.reiniciar(vertices.obtenerTamanio());
+        frontera.vaciar();
+        for (const VerticePuntuado& semilla : semillas) {
+            if (semilla.vertice >= 0 && semilla.vertice < vertices.obtenerTamanio()) {
+                acumularPuntuacion(frontera, visitados, semilla.vertice, semilla.puntuacion);
+            }
+        }
+        if (frontera.estaVacia()) {
+            return;
+        }
+
+        for (int iteracion = 0; iteracion < maxIteraciones; iteracion++) {
+            // alcanzados: distribución siguiente, con sus posiciones en visitadosNivel
+            visitadosNivel.reiniciar(vertices.obtenerTamanio());
+            alcanzados.vaciar();
+
+            double masaSinSalida = 0.0;
+            for (const VerticePuntuado& actual : frontera) {
+                RangoAristas rango = rangoCongelado(actual.vertice);
+                int pesoTotal = 0;
+                for (const Arista& arista : rango) {
+                    pesoTotal += arista.peso;
+                }
+
+                if (pesoTotal == 0) {
+                    masaSinSalida += actual.puntuacion;
+                    continue;
+                }
+
+                double masa = (1.0 - probabilidadReinicio) * actual.puntuacion / pesoTotal;
+                for (const Arista& arista : rango) {
+                    acumularPuntuacion(alcanzados, visitadosNivel, arista.destino, masa * arista.peso);
+                }
+            }
+
+            double reinicio = probabilidadReinicio + (1.0 - probabilidadReinicio) * masaSinSalida;
+            for (const VerticePuntuado& semilla : semillas) {
+                if (semilla.vertice >= 0 && semilla.vertice < vertices.obtenerTamanio()) {
+                    acumularPuntuacion(alcanzados, visitadosNivel, semilla.vertice, reinicio * semilla.puntuacion);
+                }
+            }
+
+            // Cambio entre las dos distribuciones
+            double cambio = 0.0;
+            for (const VerticePuntuado& siguiente : alcanzados) {
+                double anterior = visitados.contiene(siguiente.vertice)
+                                      ? frontera.obtener(visitados.obtenerValor(siguiente.vertice)).puntuacion
+                                      : 0.0;
+                cambio += std::fabs(siguiente.puntuacion - anterior);
+            }
+            for (const VerticePuntuado& actual : frontera) {
+                if (!visitadosNivel.contiene(actual.vertice)) {
+                    cambio += actual.puntuacion;
+                }
+            }
+
+            std::swap(frontera, alcanzados);
+            std::swap(visitados, visitadosNivel);
+
+            if (cambio < tolerancia) {
+                break;
+            }
+        }
+
+        resultado.reservar(frontera.obtenerTamanio());
+        for (const VerticePuntuado& puntuado : frontera) {
+            resultado.agregar(puntuado);
+        }
+    }
+
+    // Obtener vértices adyacentes (BFS)
+    Lista<T> obtenerVecinosBFS(const T& origen) const {
+        Lista<T> resultado;
+        int indiceOrigen = buscarVertice(origen);
+
+        if (indiceOrigen == -1) {
+            return resultado;
+        }
+
+        congelar();
+        visitados.reiniciar(vertices.obtenerTamanio());
+
+        // Cola para BFS: arreglo con un índice de lectura
+        pendientes.vaciar();
+        pendientes.agregar(indiceOrigen);
+        visitados.marcar(indiceOrigen);
+
+        for (int frente = 0; frente < pendientes.obtenerTamanio(); frente++) {
+            int actual = pendientes.obtener(frente);
 
             // No agregar el vértice origen al resultado
             if (actual != indiceOrigen) {
                 resultado.agregar(vertices.obtener(actual));
             }
 
-            // Explorar vecinos
-            Lista<Arista> vecinos = adyacencia.obtener(actual);
-            for (int i = 0; i < vecinos.obtenerTamanio(); i++) {
-                int vecino = vecinos.obtener(i).destino;
-                if (!visitados[vecino]) {
-                    cola.encolar(vecino);
-                    visitados[vecino] = true;
+            // Explorar vecinos
+            for (const Arista& arista : rangoCongelado(actual)) {
+                int vecino = arista.destino;
+                if (!visitados.contiene(vecino)) {
+                    pendientes.agregar(vecino);
+                    visitados.marcar(vecino);
+                }
+            }
+        }
+
+        return resultado;
+    }
+
+    // Obtener vértices adyacentes (DFS)
+    // Usa una pila explícita, así que la profundidad del grafo no está limitada por la pila de llamadas
+    Lista<T> obtenerVecinosDFS(const T& origen) const {
+        Lista<T> resultado;
+        int indiceOrigen = buscarVertice(origen);
+
+        if (indiceOrigen == -1) {
+            return resultado;
+        }
+
+        congelar();
+        visitados.reiniciar(vertices.obtenerTamanio());
+
+        pilaDFS.vaciar();
+        pilaDFS.emplazar(indiceOrigen, 0);
+        visitados.marcar(indiceOrigen);
+
+        while (!pilaDFS.estaVacia()) {
+            MarcoDFS& marco = pilaDFS.obtener(pilaDFS.obtenerTamanio() - 1);
+            RangoAristas rango = rangoCongelado(marco.vertice);
+
+            // Saltar los vecinos ya visitados
+            while (marco.arista < rango.obtenerTamanio() &&
+                   visitados.contiene(rango.inicio[marco.arista].destino)) {
+                marco.arista++;
+            }
+
+            if (marco.arista == rango.obtenerTamanio()) {
+                pilaDFS.eliminar(pilaDFS.obtenerTamanio() - 1);
+                continue;
+            }
+
+            // Descender al siguiente vecino (el marco puede invalidarse al apilar)
+            int vecino = rango.inicio[marco.arista].destino;
+            marco.arista++;
+
+            visitados.marcar(vecino);
+            resultado.agregar(vertices.obtener(vecino));
+            pilaDFS.emplazar(vecino, 0);
+        }
+
+        return resultado;
+    }
+
+    // Vaciar el grafo
+    void vaciar() {
+        vertices.vaciar();
+        identificadores.vaciar();
+        adyacencia.vaciar();
+        desplazamientos.vaciar();
+        aristas.vaciar();
+        congelado = false;
+    }
+
+    // Obtener número de vértices
+    int obtenerNumVertices() const {
+        return vertices.obtenerTamanio();
+    }
+
+private:
+    // Aristas salientes de un vértice en el CSR (el grafo debe estar congelado)
+    RangoAristas rangoCongelado(int id) const {
+        RangoAristas rango;
+        rango.inicio = aristas.begin() + desplazamientos.obtener(id);
+        rango.fin = aristas.begin() + desplazamientos.obtener(id + 1);
+        return rango;
+    }
+
+    // Sumar una puntuación al vértice, agregándolo si aún no estaba
+    // Las marcas guardan la posición de cada vértice en la lista
+    static void acumularPuntuacion(Lista<VerticePuntuado>& puntuados, MarcasEpoca& posiciones,
+                                   int vertice, double puntuacion) {
+        if (posiciones.contiene(vertice)) {
+            puntuados.obtener(posiciones.obtenerValor(vertice)).puntuacion += puntuacion;
+        } else {
+            posiciones.marcar(vertice, puntuados.obtenerTamanio());
+            puntuados.emplazar(vertice, puntuacion);
+        }
+    }
+
+};
+
+// ==================== UTILIDADES ====================
+
+/**
+ * @brief Vista de solo lectura sobre una cadena de caracteres que no es dueña de ellos
+ *
+ * Permite referirse a los textos de la biblioteca mapeada en memoria sin copiarlos.
+ * El texto referenciado debe vivir más que la vista.
+ */
+class VistaCadena {
+private:
+    const char* datos;
+    int longitud;
+
+public:
+    // Constructor por defecto (cadena vacía)
+    VistaCadena() : datos(""), longitud(0) {}
+
+    // Constructor a partir de un puntero y una longitud
+    VistaCadena(const char* _datos, int _longitud) : datos(_datos), longitud(_longitud) {}
+
+    // Constructor a partir de una cadena terminada en nulo
+    VistaCadena(const char* _cadena) : datos(_cadena), longitud(static_cast<int>(std::strlen(_cadena))) {}
+
+    // Constructor a partir de un std::string (no copia el contenido)
+    VistaCadena(const std::string& _cadena)
+        : datos(_cadena.data()), longitud(static_cast<int>(_cadena.length())) {}
+
+    // Obtener puntero al primer carácter
+    const char* obtenerDatos() const {
+        return datos;
+    }
+
+    // Obtener número de bytes
+    int obtenerLongitud() const {
+        return longitud;
+    }
+
+    // Verificar si la vista está vacía
+    bool estaVacia() const {
+        return longitud == 0;
+    }
+
+    char operator[](int indice) const {
+        return datos[indice];
+    }
+
+    // Copiar el contenido a un std::string
+    std::string aCadena() const {
+        return std::string(datos, longitud);
+    }
+
+    // Comparación lexicográfica byte a byte (mismo orden que std::string)
+    int comparar(const VistaCadena& otra) const {
+        int minimo = std::min(longitud, otra.longitud);
+        int resultado = minimo > 0 ? std::memcmp(datos, otra.datos, minimo) : 0;
+
+        if (resultado != 0) {
+            return resultado;
+        }
+        return longitud < otra.longitud ? -1 : (longitud > otra.longitud ? 1 : 0);
+    }
+
+    // Primeros 8 bytes como entero big-endian, rellenando con ceros
+    // Respeta el orden de comparar: si a.obtenerPrefijo() < b.obtenerPrefijo() entonces a < b
+    uint64_t obtenerPrefijo() const {
+        uint64_t prefijo = 0;
+        for (int i = 0; i < 8; i++) {
+            unsigned char byte = i < longitud ? static_cast<unsigned char>(datos[i]) : 0;
+            prefijo = (prefijo << 8) | byte;
+        }
+        return prefijo;
+    }
+
+    // Operadores de comparación
+    bool operator==(const VistaCadena& otra) const {
+        return longitud == otra.longitud && comparar(otra) == 0;
+    }
+
+    bool operator!=(const VistaCadena& otra) const {
+        return !(*this == otra);
+    }
+
+    bool operator<(const VistaCadena& otra) const {
+        return comparar(otra) < 0;
+    }
+};
+
+inline std::ostream& operator<<(std::ostream& salida, const VistaCadena& vista) {
+    return salida.write(vista.obtenerDatos(), vista.obtenerLongitud());
+}
+
+template <>
+struct FuncionHash<VistaCadena> {
+    static uint32_t calcular(const VistaCadena& valor) {
+        return FuncionHash<std::string>::calcularBytes(valor.obtenerDatos(), valor.obtenerLongitud());
+    }
+};
+
+/**
+ * @brief Lectura y escritura de enteros en el formato binario de la biblioteca
+ * (32 bits, little-endian, sin requisitos de alineación)
+ */
+class CodificacionBinaria {
+public:
+    // Lee un entero de 32 bits desde una posición arbitraria
+    static int leerEntero32(const char* origen) {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(origen);
+        uint32_t valor = static_cast<uint32_t>(bytes[0]) |
+                         (static_cast<uint32_t>(bytes[1]) << 8) |
+                         (static_cast<uint32_t>(bytes[2]) << 16) |
+                         (static_cast<uint32_t>(bytes[3]) << 24);
+        return static_cast<int32_t>(valor);
+    }
+
+    // Escribe un entero de 32 bits en una posición arbitraria
+    static void escribirEntero32(char* destino, int valor) {
+        uint32_t sinSigno = static_cast<uint32_t>(valor);
+        for (int i = 0; i < 4; i++) {
+            destino[i] = static_cast<char>((sinSigno >> (8 * i)) & 0xFF);
+        }
+    }
+
+    // Añade un entero de 32 bits al final de un búfer
+    static void agregarEntero32(std::string& destino, int valor) {
+        char bytes[4];
+        escribirEntero32(bytes, valor);
+        destino.append(bytes, 4);
+    }
+
+    // Lee un entero de 64 bits guardado como dos mitades de 32 bits (la baja primero)
+    static int64_t leerEntero64(const char* origen) {
+        uint64_t baja = static_cast<uint32_t>(leerEntero32(origen));
+        uint64_t alta = static_cast<uint32_t>(leerEntero32(origen + 4));
+        return static_cast<int64_t>(baja | (alta << 32));
+    }
+
+    // Añade un entero de 64 bits al final de un búfer
+    static void agregarEntero64(std::string& destino, int64_t valor) {
+        uint64_t sinSigno = static_cast<uint64_t>(valor);
+        agregarEntero32(destino, static_cast<int>(static_cast<uint32_t>(sinSigno)));
+        agregarEntero32(destino, static_cast<int>(static_cast<uint32_t>(sinSigno >> 32)));
+    }
+};
+
+/**
+ * @brief Almacén de texto por bloques
+ *
+ * Los bytes guardados nunca se mueven, de modo que las vistas que apuntan a ellos
+ * siguen siendo válidas mientras viva el almacén.
+ */
+class AlmacenTexto {
+private:
+    struct Bloque {
+        char* datos;
+        int capacidad;
+        int usado;
+        Bloque* siguiente;
+    };
+
+    static const int TAMANIO_BLOQUE = 64 * 1024;
+
+    Bloque* actual;
+
+public:
+    // Constructor
+    AlmacenTexto() : actual(nullptr) {}
+
+    // Destructor
+    ~AlmacenTexto() {
+        vaciar();
+    }
+
+    AlmacenTexto(const AlmacenTexto&) = delete;
+    AlmacenTexto& operator=(const AlmacenTexto&) = delete;
+
+    // Reservar bytes contiguos
+    char* reservar(int bytes) {
+        if (actual == nullptr || actual->usado + bytes > actual->capacidad) {
+            Bloque* nuevo = new Bloque;
+            nuevo->capacidad = bytes > TAMANIO_BLOQUE ? bytes : TAMANIO_BLOQUE;
+            nuevo->datos = new char[nuevo->capacidad];
+            nuevo->usado = 0;
+            nuevo->siguiente = actual;
+            actual = nuevo;
+        }
+
+        char* resultado = actual->datos + actual->usado;
+        actual->usado += bytes;
+        return resultado;
+    }
+
+    // Devolver los últimos bytes reservados que no se llegaron a usar
+    void devolver(int bytes) {
+        if (actual != nullptr && bytes <= actual->usado) {
+            actual->usado -= bytes;
+        }
+    }
+
+    // Copiar un texto al almacén y devolver una vista estable sobre la copia
+    VistaCadena guardar(const VistaCadena& texto) {
+        if (texto.estaVacia()) {
+            return VistaCadena();
+        }
+
+        char* destino = reservar(texto.obtenerLongitud());
+        std::memcpy(destino, texto.obtenerDatos(), texto.obtenerLongitud());
+        return VistaCadena(destino, texto.obtenerLongitud());
+    }
+
+    // Liberar todos los bloques
+    void vaciar() {
+        while (actual != nullptr) {
+            Bloque* temp = actual;
+            actual = actual->siguiente;
+            delete[] temp->datos;
+            delete temp;
+        }
+    }
+};
+
+/**
+ * @brief Utilidades para manejar caracteres UTF-8 en español
+ */
+class UTF8Util {
+public:
+    // Formatea un texto para que tenga un ancho específico
+    static std::string formatearTexto(const VistaCadena& texto, int ancho) {
+        // Verificar límites para evitar errores
+        if (ancho <= 0) {
+            return "";
+        }
+
+        size_t longitudTexto = static_cast<size_t>(texto.obtenerLongitud());
+
+        if (longitudTexto > static_cast<size_t>(ancho)) {
+            // Asegurar que no excedemos el tamaño del string
+            size_t longitud = std::min(longitudTexto, static_cast<size_t>(ancho - 3));
+            return std::string(texto.obtenerDatos(), longitud) + "...";
+        }
+
+        // Limitar el tamaño del padding para evitar strings muy grandes
+        size_t padding = std::min(static_cast<size_t>(ancho - longitudTexto), static_cast<size_t>(100));
+        return texto.aCadena() + std::string(padding, ' ');
+    }
+
+    // Crea una línea de separación
+    static std::string formatearLinea(int longitud) {
+        // Limitar la longitud para evitar strings muy grandes
+        longitud = std::min(longitud, 200);
+        return std::string(longitud, '-');
+    }
+
+    // Formatea un título centrado
+    static std::string formatearTitulo(const std::string& titulo) {
+        const int ancho = 80;
+
+        // Verificar que el título no sea demasiado largo
+        if (titulo.length() > static_cast<size_t>(ancho)) {
+            return titulo.substr(0, ancho - 3) + "...";
+        }
+
+        int espacios = (ancho - titulo.length()) / 2;
+        espacios = std::max(0, espacios); // Asegurar que no sea negativo
+
+        return std::string(espacios, ' ') + titulo;
+    }
+
+    // Caracteres especiales en español
+    static std::string A_ACENTO() { return "á"; }
+    static std::string E_ACENTO() { return "é"; }
+    static std::string I_ACENTO() { return "í"; }
+    static std::string O_ACENTO() { return "ó"; }
+    static std::string U_ACENTO() { return "ú"; }
+    static std::string N_TILDE() { return "ñ"; }
+};
+
+/**
+ * @brief Claves de colación: texto sin mayúsculas ni acentos
+ *
+ * Las letras latinas (ASCII, Latin-1 y Latin Extended-A) se pliegan a su letra base
+ * en minúscula ("Canción" -> "cancion", "Æ" -> "ae"); el resto de caracteres se copia
+ * tal cual. La clave nunca es más larga que el texto original, y dos textos que solo
+ * difieren en mayúsculas o acentos tienen la misma clave, así que basta con comparar
+ * bytes (memcmp) para ordenar y buscar sin distinguir mayúsculas ni acentos.
+ */
+class Colacion {
+private:
+    // Letra base de U+00C0..U+00FF; '.' se copia tal cual, '*' = "ae", '+' = "th", '$' = "ss"
+    static const char* tablaLatin1() {
+        return "aaaaaa*ceeeeiiiidnooooo.ouuuuy+$aaaaaa*ceeeeiiiidnooooo.ouuuuy+y";
+    }
+
+    // Letra base de U+0100..U+017F; '&' = "ij", '#' = "oe"
+    static const char* tablaLatinExtendidoA() {
+        return "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii&&jjkkkllllllllllnnnnnnnnnoooooo##"
+               "rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+    }
+
+    // Escribir el plegado de una letra de las tablas y devolver los bytes escritos
+    static int escribirBase(char base, char* destino) {
+        const char* digrafo = nullptr;
+        switch (base) {
+            case '*': digrafo = "ae"; break;
+            case '+': digrafo = "th"; break;
+            case '$': digrafo = "ss"; break;
+            case '&': digrafo = "ij"; break;
+            case '#': digrafo = "oe"; break;
+            default:
+                destino[0] = base;
+                return 1;
+        }
+        destino[0] = digrafo[0];
+        destino[1] = digrafo[1];
+        return 2;
+    }
+
+public:
+    // Normalizar un texto en destino (al menos texto.obtenerLongitud() bytes) y devolver la longitud
+    static int normalizar(const VistaCadena& texto, char* destino) {
+        const unsigned char* datos = reinterpret_cast<const unsigned char*>(texto.obtenerDatos());
+        int n = texto.obtenerLongitud();
+        int escritos = 0;
+
+        for (int i = 0; i < n; ) {
+            unsigned char c = datos[i];
+
+            if (c < 0x80) {
+                destino[escritos++] = static_cast<char>(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c);
+                i++;
+                continue;
+            }
+
+            // Secuencias de dos bytes: U+0080..U+07FF
+            if ((c & 0xE0) == 0xC0 && i + 1 < n && (datos[i + 1] & 0xC0) == 0x80) {
+                int codigo = ((c & 0x1F) << 6) | (datos[i + 1] & 0x3F);
+                char base = '.';
+
+                if (codigo >= 0xC0 && codigo <= 0xFF) {
+                    base = tablaLatin1()[codigo - 0xC0];
+                } else if (codigo >= 0x100 && codigo <= 0x17F) {
+                    base = tablaLatinExtendidoA()[codigo - 0x100];
+                }
+
+                if (base != '.') {
+                    escritos += escribirBase(base, destino + escritos);
+                } else {
+                    destino[escritos++] = static_cast<char>(datos[i]);
+                    destino[escritos++] = static_cast<char>(datos[i + 1]);
+                }
+                i += 2;
+                continue;
+            }
+
+            // Cualquier otro byte se copia sin cambios
+            destino[escritos++] = static_cast<char>(c);
+            i++;
+        }
+
+        return escritos;
+    }
+
+    // Normalizar un texto en un std::string (para consultas)
+    static std::string normalizar(const VistaCadena& texto) {
+        std::string resultado(texto.obtenerLongitud(), '\0');
+        if (!resultado.empty()) {
+            resultado.resize(normalizar(texto, &resultado[0]));
+        }
+        return resultado;
+    }
+
+    // Normalizar un texto guardando la clave en el almacén
+    // Si la clave coincide con el texto, se devuelve el propio texto sin copiarlo
+    static VistaCadena normalizar(const VistaCadena& texto, AlmacenTexto& almacen) {
+        char* destino = almacen.reservar(texto.obtenerLongitud());
+        int longitud = normalizar(texto, destino);
+
+        if (longitud == texto.obtenerLongitud() &&
+            std::memcmp(destino, texto.obtenerDatos(), longitud) == 0) {
+            almacen.devolver(texto.obtenerLongitud());
+            return texto;
+        }
+
+        almacen.devolver(texto.obtenerLongitud() - longitud);
+        return VistaCadena(destino, longitud);
+    }
+};
+
+// ==================== ALGORITMOS ====================
+
+/**
+ * @brief Algoritmos de búsqueda
+ */
+class Busqueda {
+public:
+    // Verifica si un texto contiene otro, byte a byte y sin reservar memoria
+    // Para ignorar mayúsculas y acentos se aplica a claves de Colacion
+    static bool contiene(const VistaCadena& texto, const VistaCadena& busqueda) {
+        int n = texto.obtenerLongitud();
+        int m = busqueda.obtenerLongitud();
+
+        if (m == 0) {
+            return true;
+        }
+
+        const char* datos = texto.obtenerDatos();
+        const char* fin = datos + n - m;
+        for (const char* inicio = datos; inicio <= fin; inicio++) {
+            inicio = static_cast<const char*>(std::memchr(inicio, busqueda[0], fin - inicio + 1));
+            if (inicio == nullptr) {
+                return false;
+            }
+            if (std::memcmp(inicio, busqueda.obtenerDatos(), m) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Quedarse con los candidatos que también aparecen en la lista (ambas ordenadas)
+    static void intersectar(Lista<int>& candidatos, const Lista<int>& lista) {
+        Lista<int> resultado;
+        int j = 0;
+
+        for (int candidato : candidatos) {
+            // Búsqueda exponencial: la lista suele ser mucho más larga que los candidatos
+            int paso = 1;
+            int limite = j;
+            while (limite < lista.obtenerTamanio() && lista.obtener(limite) < candidato) {
+                j = limite + 1;
+                limite += paso;
+                paso *= 2;
+            }
+
+            int fin = std::min(limite, lista.obtenerTamanio() - 1);
+            while (j <= fin) {
+                int medio = j + (fin - j) / 2;
+                if (lista.obtener(medio) < candidato) {
+                    j = medio + 1;
+                } else {
+                    fin = medio - 1;
+                }
+            }
+
+            if (j < lista.obtenerTamanio() && lista.obtener(j) == candidato) {
+                resultado.agregar(candidato);
+            }
+        }
+
+        candidatos = std::move(resultado);
+    }
+
+    // Primera posición de una lista ordenada cuyo valor no es menor que el dado
+    static int cotaInferior(const Lista<int>& lista, int valor) {
+        int inicio = 0;
+        int fin = lista.obtenerTamanio();
+        while (inicio < fin) {
+            int medio = inicio + (fin - inicio) / 2;
+            if (lista.obtener(medio) < valor) {
+                inicio = medio + 1;
+            } else {
+                fin = medio;
+            }
+        }
+        return inicio;
+    }
+
+    // Quitar un valor de una lista ordenada; devuelve false si no estaba
+    static bool eliminarOrdenado(Lista<int>& lista, int valor) {
+        int posicion = cotaInferior(lista, valor);
+        if (posicion == lista.obtenerTamanio() || lista.obtener(posicion) != valor) {
+            return false;
+        }
+        lista.eliminar(posicion);
+        return true;
+    }
+};
+
+/**
+ * @brief Patrón para búsquedas aproximadas con el algoritmo paralelo de bits de Myers
+ *
+ * Calcula la menor distancia de edición (inserciones, borrados y sustituciones) entre
+ * el patrón y cualquier subcadena de un texto. Cada columna de la matriz de programación
+ * dinámica se guarda como diferencias verticales en dos palabras de 64 bits, así que
+ * cada byte del texto cuesta unas pocas operaciones de bits. Admite hasta 64 bytes.
+ */
+class PatronDifuso {
+private:
+    uint64_t mascaras[256];   // Posiciones del patrón donde aparece cada byte
+    int longitud;
+
+public:
+    static const int LONGITUD_MAXIMA = 64;
+
+    // Constructor: los bytes que pasen de LONGITUD_MAXIMA se ignoran
+    explicit PatronDifuso(const VistaCadena& patron)
+        : longitud(patron.obtenerLongitud() > LONGITUD_MAXIMA ? LONGITUD_MAXIMA : patron.obtenerLongitud()) {
+        std::memset(mascaras, 0, sizeof(mascaras));
+        for (int i = 0; i < longitud; i++) {
+            mascaras[static_cast<unsigned char>(patron[i])] |= 1ull << i;
+        }
+    }
+
+    int obtenerLongitud() const {
+        return longitud;
+    }
+
+    // Menor distancia entre el patrón y alguna subcadena del texto
+    // El resultado es exacto si no supera el límite; si lo supera, se deja de recorrer
+    // el texto en cuanto ya no puede bajar de él y se devuelve algún valor mayor
+    int distancia(const VistaCadena& texto, int limite) const {
+        if (longitud == 0) {
+            return 0;
+        }
+
+        const unsigned char* datos = reinterpret_cast<const unsigned char*>(texto.obtenerDatos());
+        const int n = texto.obtenerLongitud();
+        const uint64_t bitFinal = 1ull << (longitud - 1);
+        uint64_t positivos = ~0ull;   // Diferencias verticales +1
+        uint64_t negativos = 0;       // Diferencias verticales -1
+        int puntuacion = longitud;
+        int mejor = longitud;
+
+        for (int j = 0; j < n; j++) {
+            uint64_t iguales = mascaras[datos[j]];
+            uint64_t xv = iguales | negativos;
+            uint64_t xh = (((iguales & positivos) + positivos) ^ positivos) | iguales;
+            uint64_t horizontalesPositivos = negativos | ~(xh | positivos);
+            uint64_t horizontalesNegativos = positivos & xh;
+
+            if (horizontalesPositivos & bitFinal) {
+                puntuacion++;
+            } else if (horizontalesNegativos & bitFinal) {
+                puntuacion--;
+            }
+
+            // La fila cero vale 0 en todas las columnas: la coincidencia puede empezar en cualquier byte
+            horizontalesPositivos <<= 1;
+            horizontalesNegativos <<= 1;
+            positivos = horizontalesNegativos | ~(xv | horizontalesPositivos);
+            negativos = horizontalesPositivos & xv;
+
+            if (puntuacion < mejor) {
+                mejor = puntuacion;
+                if (mejor == 0) {
+                    break;
+                }
+            }
+
+            // La puntuación baja como mucho uno por byte: si no puede llegar al límite, parar
+            if (puntuacion - (n - 1 - j) > limite) {
+                break;
+            }
+        }
+
+        return mejor;
+    }
+};
+
+/**
+ * @brief Columna de texto empaquetada para búsquedas por fuerza bruta
+ *
+ * Guarda seguidos en un único bloque los campos de cada documento, terminados en
+ * '\0', y el desplazamiento donde empieza cada campo. Una búsqueda recorre el bloque
+ * completo: con AVX2 o SSE2 se comparan 32 o 16 posiciones a la vez contra el primer
+ * y el último byte de la consulta, y solo donde coinciden ambos se llama a memcmp;
+ * sin SIMD se salta de candidato en candidato con memchr. Los campos deben ser
+ * claves de Colacion para que la búsqueda no distinga mayúsculas ni acentos.
+ */
+class ColumnaTexto {
+private:
+    // Bytes a cero tras el texto para que las cargas SIMD nunca salgan del bloque
+    static const int RELLENO = 64;
+
+    char* datos;
+    int usado;
+    int capacidad;
+    int numCampos;
+    Lista<int> inicios;   // Inicio de cada campo: inicios[documento * numCampos + campo]
+
+    // Asegurar espacio para los bytes indicados más el relleno
+    void asegurarCapacidad(int bytes) {
+        if (usado + bytes + RELLENO <= capacidad) {
+            return;
+        }
+
+        int nuevaCapacidad = capacidad == 0 ? 4096 : capacidad;
+        while (nuevaCapacidad < usado + bytes + RELLENO) {
+            nuevaCapacidad *= 2;
+        }
+
+        char* nuevos = new char[nuevaCapacidad];
+        if (usado > 0) {
+            std::memcpy(nuevos, datos, usado);
+        }
+        std::memset(nuevos + usado, 0, nuevaCapacidad - usado);
+
+        delete[] datos;
+        datos = nuevos;
+        capacidad = nuevaCapacidad;
+    }
+
+    // Primera posición >= desde donde empieza la consulta (o -1)
+    // La consulta no contiene '\0', así que nunca coincide a caballo entre dos campos
+    int siguienteCoincidencia(int desde, const char* consulta, int m) const {
+        const int ultimo = usado - m;   // Última posición donde cabe la consulta
+
+#if defined(__AVX2__)
+        const __m256i primero = _mm256_set1_epi8(consulta[0]);
+        const __m256i final = _mm256_set1_epi8(consulta[m - 1]);
+
+        for (int i = desde; i <= ultimo; i += 32) {
+            __m256i inicio = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(datos + i));
+            __m256i fin = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(datos + i + m - 1));
+            uint32_t mascara = static_cast<uint32_t>(_mm256_movemask_epi8(
+                _mm256_and_si256(_mm256_cmpeq_epi8(inicio, primero), _mm256_cmpeq_epi8(fin, final))));
+
+            while (mascara != 0) {
+                int posicion = i + __builtin_ctz(mascara);
+                if (posicion > ultimo) {
+                    return -1;
+                }
+                if (std::memcmp(datos + posicion, consulta, m) == 0) {
+                    return posicion;
+                }
+                mascara &= mascara - 1;
+            }
+        }
+        return -1;
+#elif defined(__SSE2__)
+        const __m128i primero = _mm_set1_epi8(consulta[0]);
+        const __m128i final = _mm_set1_epi8(consulta[m - 1]);
+
+        for (int i = desde; i <= ultimo; i += 16) {
+            __m128i inicio = _mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i));
+            __m128i fin = _mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i + m - 1));
+            uint32_t mascara = static_cast<uint32_t>(_mm_movemask_epi8(
+                _mm_and_si128(_mm_cmpeq_epi8(inicio, primero), _mm_cmpeq_epi8(fin, final))));
+
+            while (mascara != 0) {
+                int posicion = i + __builtin_ctz(mascara);
+                if (posicion > ultimo) {
+                    return -1;
+                }
+                if (std::memcmp(datos + posicion, consulta, m) == 0) {
+                    return posicion;
+                }
+                mascara &= mascara - 1;
+            }
+        }
+        return -1;
+#else
+        for (int i = desde; i <= ultimo; i++) {
+            const char* candidato = static_cast<const char*>(std::memchr(datos + i, consulta[0], ultimo - i + 1));
+            if (candidato == nullptr) {
+                return -1;
+            }
+            i = static_cast<int>(candidato - datos);
+            if (std::memcmp(candidato, consulta, m) == 0) {
+                return i;
+            }
+        }
+        return -1;
+#endif
+    }
+
+    // Campo que contiene una posición del bloque, buscando a partir de otro campo
+    // Búsqueda exponencial: la coincidencia suele estar cerca del campo anterior
+    int campoEnPosicion(int posicion, int desdeCampo) const {
+        int inicio = desdeCampo;
+        int fin = inicios.obtenerTamanio() - 1;
+        int paso = 1;
+
+        while (inicio + paso <= fin && inicios.obtener(inicio + paso) <= posicion) {
+            inicio += paso;
+            paso *= 2;
+        }
+        fin = std::min(fin, inicio + paso - 1);
+
+        while (inicio < fin) {
+            int medio = inicio + (fin - inicio + 1) / 2;
+            if (inicios.obtener(medio) <= posicion) {
+                inicio = medio;
+            } else {
+                fin = medio - 1;
+            }
+        }
+        return inicio;
+    }
+
+public:
+    // Constructor: cada documento tiene la cantidad de campos indicada
+    explicit ColumnaTexto(int _numCampos) : datos(nullptr), usado(0), capacidad(0), numCampos(_numCampos) {}
+
+    // Destructor
+    ~ColumnaTexto() {
+        delete[] datos;
+    }
+
+    ColumnaTexto(const ColumnaTexto&) = delete;
+    ColumnaTexto& operator=(const ColumnaTexto&) = delete;
+
+    // Agregar el siguiente campo (los campos de un documento se agregan en orden)
+    void agregarCampo(const VistaCadena& texto) {
+        int n = texto.obtenerLongitud();
+        asegurarCapacidad(n + 1);
+
+        inicios.agregar(usado);
+        if (n > 0) {
+            std::memcpy(datos + usado, texto.obtenerDatos(), n);
+        }
+        datos[usado + n] = '\0';
+        usado += n + 1;
+    }
+
+    // Buscar los documentos con algún campo de la máscara (bit 1 << campo) que contenga la consulta
+    // Los documentos se devuelven en orden creciente y sin repetir
+    void buscar(const VistaCadena& consulta, unsigned int mascaraCampos, Lista<int>& resultado) const {
+        resultado.vaciar();
+        int m = consulta.obtenerLongitud();
+        int numDocumentos = obtenerNumDocumentos();
+
+        if (m == 0) {
+            for (int documento = 0; documento < numDocumentos; documento++) {
+                resultado.agregar(documento);
+            }
+            return;
+        }
+        if (std::memchr(consulta.obtenerDatos(), '\0', m) != nullptr) {
+            return;
+        }
+
+        int posicion = 0;
+        int campo = 0;
+        while ((posicion = siguienteCoincidencia(posicion, consulta.obtenerDatos(), m)) != -1) {
+            campo = campoEnPosicion(posicion, campo);
+            int documento = campo / numCampos;
+
+            if (mascaraCampos & (1u << (campo % numCampos))) {
+                // Basta una coincidencia por documento: saltar al siguiente
+                resultado.agregar(documento);
+                campo = (documento + 1) * numCampos;
+            } else {
+                campo++;
+            }
+
+            if (campo >= inicios.obtenerTamanio()) {
+                break;
+            }
+            posicion = inicios.obtener(campo);
+        }
+    }
+
+    // Obtener el texto de un campo de un documento
+    VistaCadena obtenerCampo(int documento, int campo) const {
+        int i = documento * numCampos + campo;
+        int inicio = inicios.obtener(i);
+        int fin = i + 1 < inicios.obtenerTamanio() ? inicios.obtener(i + 1) : usado;
+        return VistaCadena(datos + inicio, fin - inicio - 1);
+    }
+
+    int obtenerNumDocumentos() const {
+        return inicios.obtenerTamanio() / numCampos;
+    }
+
+    // Vaciar la columna (conserva el bloque reservado)
+    void vaciar() {
+        usado = 0;
+        inicios.vaciar();
+        if (datos != nullptr) {
+            std::memset(datos, 0, capacidad);
+        }
+    }
+};
+
+/**
+ * @brief Índice invertido de trigramas para búsquedas de subcadenas
+ *
+ * Cada trigrama (tres bytes consecutivos del texto en minúsculas) apunta a la
+ * lista ordenada de documentos que lo contienen. Una consulta de al menos tres
+ * bytes solo puede aparecer en los documentos que contienen todos sus trigramas,
+ * así que basta con intersectar esas listas y verificar los pocos candidatos.
+ */
+class IndiceTexto {
+private:
+    TablaHash<int, int> posiciones;   // Trigrama -> posición de su lista de documentos
+    Lista<Lista<int>> documentos;     // Listas de documentos en orden creciente
+
+    // Codificar tres bytes en minúsculas como un entero
+    static int codificarTrigrama(const char* texto) {
+        return (static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(texto[0]))) << 16) |
+               (static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(texto[1]))) << 8) |
+               static_cast<unsigned char>(std::tolower(static_cast<unsigned char>(texto[2])));
+    }
+
+    // Siguiente documento de una lista durante la mezcla de listas ordenadas
+    struct CabezaLista {
+        int documento;
+        const Lista<int>* lista;
+        int posicion;
+
+        CabezaLista(int _documento, const Lista<int>* _lista, int _posicion)
+            : documento(_documento), lista(_lista), posicion(_posicion) {}
+
+        bool operator>(const CabezaLista& otra) const {
+            return documento > otra.documento;
+        }
+    };
+
+public:
+    static const int LONGITUD_TRIGRAMA = 3;
+
+    // Indexar el texto de un documento; los identificadores deben agregarse en orden creciente
+    void agregar(int documento, const VistaCadena& texto) {
+        for (int i = 0; i + LONGITUD_TRIGRAMA <= texto.obtenerLongitud(); i++) {
+            int trigrama = codificarTrigrama(texto.obtenerDatos() + i);
+
+            int* posicion = posiciones.buscar(trigrama);
+            if (posicion == nullptr) {
+                posiciones.insertar(trigrama, documentos.obtenerTamanio());
+                documentos.emplazar().agregar(documento);
+                continue;
+            }
+
+            // Un trigrama repetido en el mismo texto se registra una sola vez
+            Lista<int>& lista = documentos.obtener(*posicion);
+            if (lista.estaVacia() || lista.obtener(lista.obtenerTamanio() - 1) != documento) {
+                lista.agregar(documento);
+            }
+        }
+    }
+
+    // Obtener en orden creciente los documentos que podrían contener la consulta
+    // Devuelve false si la consulta es demasiado corta para usar el índice
+    bool obtenerCandidatos(const VistaCadena& consulta, Lista<int>& candidatos) const {
+        if (consulta.obtenerLongitud() < LONGITUD_TRIGRAMA) {
+            return false;
+        }
+
+        // Empezar por la lista más corta para que la intersección sea mínima
+        int numTrigramas = consulta.obtenerLongitud() - LONGITUD_TRIGRAMA + 1;
+        const Lista<int>* masCorta = nullptr;
+
+        for (int i = 0; i < numTrigramas; i++) {
+            const int* posicion = posiciones.buscar(codificarTrigrama(consulta.obtenerDatos() + i));
+            if (posicion == nullptr) {
+                candidatos.vaciar();
+                return true;
+            }
+
+            const Lista<int>& lista = documentos.obtener(*posicion);
+            if (masCorta == nullptr || lista.obtenerTamanio() < masCorta->obtenerTamanio()) {
+                masCorta = &lista;
+            }
+        }
+
+        candidatos = *masCorta;
+
+        for (int i = 0; i < numTrigramas && !candidatos.estaVacia(); i++) {
+            const Lista<int>& lista = documentos.obtener(*posiciones.buscar(codificarTrigrama(consulta.obtenerDatos() + i)));
+            if (&lista != masCorta) {
+                Busqueda::intersectar(candidatos, lista);
+            }
+        }
+
+        return true;
+    }
+
+    // Descartar los candidatos (ordenados) a los que les falta algún trigrama de la consulta
+    // Devuelve false si la consulta es demasiado corta para usar el índice
+    bool filtrarCandidatos(const VistaCadena& consulta, Lista<int>& candidatos) const {
+        if (consulta.obtenerLongitud() < LONGITUD_TRIGRAMA) {
+            return false;
+        }
+
+        for (int i = 0; i + LONGITUD_TRIGRAMA <= consulta.obtenerLongitud() && !candidatos.estaVacia(); i++) {
+            const int* posicion = posiciones.buscar(codificarTrigrama(consulta.obtenerDatos() + i));
+            if (posicion == nullptr) {
+                candidatos.vaciar();
+            } else {
+                Busqueda::intersectar(candidatos, documentos.obtener(*posicion));
+            }
+        }
+        return true;
+    }
+
+    // Estimar cuántos candidatos devolvería obtenerCandidatos: el tamaño de la lista más
+    // corta de sus trigramas (-1 si la consulta es demasiado corta para usar el índice)
+    int estimarCandidatos(const VistaCadena& consulta) const {
+        if (consulta.obtenerLongitud() < LONGITUD_TRIGRAMA) {
+            return -1;
+        }
+
+        int minimo = -1;
+        for (int i = 0; i + LONGITUD_TRIGRAMA <= consulta.obtenerLongitud(); i++) {
+            const int* posicion = posiciones.buscar(codificarTrigrama(consulta.obtenerDatos() + i));
+            int tamanio = posicion != nullptr ? documentos.obtener(*posicion).obtenerTamanio() : 0;
+            if (minimo == -1 || tamanio < minimo) {
+                minimo = tamanio;
+            }
+        }
+        return minimo;
+    }
+
+    // Obtener en orden creciente los documentos que podrían contener la consulta con
+    // hasta 'tolerancia' errores. Cada error destruye como mucho tres trigramas de la
+    // consulta, así que un documento válido contiene al menos (distintos - 3 * tolerancia)
+    // de sus trigramas distintos; se cuentan mezclando las listas con un montículo.
+    // Devuelve false si con esa tolerancia el filtro no puede descartar ningún documento
+    bool obtenerCandidatosAproximados(const VistaCadena& consulta, int tolerancia, Lista<int>& candidatos) const {
+        Lista<int> trigramas;
+        for (int i = 0; i + LONGITUD_TRIGRAMA <= consulta.obtenerLongitud(); i++) {
+            int trigrama = codificarTrigrama(consulta.obtenerDatos() + i);
+            if (!trigramas.contiene(trigrama)) {
+                trigramas.agregar(trigrama);
+            }
+        }
+
+        int umbral = trigramas.obtenerTamanio() - LONGITUD_TRIGRAMA * tolerancia;
+        if (umbral <= 0) {
+            return false;
+        }
+
+        ColaPrioridad<CabezaLista, std::greater<CabezaLista>> cabezas;
+        for (int trigrama : trigramas) {
+            const int* posicion = posiciones.buscar(trigrama);
+            if (posicion != nullptr && !documentos.obtener(*posicion).estaVacia()) {
+                const Lista<int>& lista = documentos.obtener(*posicion);
+                cabezas.encolar(CabezaLista(lista.obtener(0), &lista, 0));
+            }
+        }
+
+        candidatos.vaciar();
+        int actual = -1;
+        int coincidencias = 0;
+
+        while (!cabezas.estaVacia()) {
+            CabezaLista cabeza = cabezas.frente();
+            cabezas.desencolar();
+
+            if (cabeza.documento != actual) {
+                actual = cabeza.documento;
+                coincidencias = 0;
+            }
+            if (++coincidencias == umbral) {
+                candidatos.agregar(actual);
+            }
+
+            if (cabeza.posicion + 1 < cabeza.lista->obtenerTamanio()) {
+                cabeza.posicion++;
+                cabeza.documento = cabeza.lista->obtener(cabeza.posicion);
+                cabezas.encolar(cabeza);
+            }
+        }
+
+        return true;
+    }
+
+    // Quitar un documento indexado con el texto dado; solo se tocan las listas de sus trigramas
+    // Los trigramas que solo tenía ese documento conservan su lista, vacía
+    void eliminarDocumento(int documento, const VistaCadena& texto) {
+        for (int i = 0; i + LONGITUD_TRIGRAMA <= texto.obtenerLongitud(); i++) {
+            int* posicion = posiciones.buscar(codificarTrigrama(texto.obtenerDatos() + i));
+            if (posicion != nullptr) {
+                Busqueda::eliminarOrdenado(documentos.obtener(*posicion), documento);
+            }
+        }
+    }
+
+    // Vaciar el índice
+    void vaciar() {
+        posiciones.vaciar();
+        documentos.vaciar();
+    }
+};
+
+/**
+ * @brief Árbol de prefijos compacto (radix) para autocompletar
+ *
+ * Las aristas se etiquetan con vistas sobre los textos indexados y se comparan sin
+ * distinguir mayúsculas, de modo que el árbol no copia ningún texto. Cada nodo
+ * guarda la mayor puntuación de su subárbol, lo que permite obtener las k mejores
+ * terminaciones con una búsqueda de primero el mejor sin recorrer el subárbol entero.
+ */
+class TriePrefijos {
+public:
+    // Posición de una búsqueda incremental: nodo actual y caracteres consumidos de su etiqueta
+    struct Posicion {
+        int nodo;
+        int desplazamiento;
+
+        Posicion() : nodo(0), desplazamiento(0) {}
+
+        bool esValida() const {
+            return nodo >= 0;
+        }
+    };
+
+private:
+    struct Nodo {
+        VistaCadena etiqueta;     // Texto de la arista que llega a este nodo
+        int padre;
+        int primerHijo;
+        int siguienteHermano;
+        int primeraEntrada;       // Documentos cuya clave termina aquí
+        int maximaPuntuacion;     // Mayor puntuación del subárbol
+
+        Nodo(const VistaCadena& _etiqueta, int _padre)
+            : etiqueta(_etiqueta), padre(_padre), primerHijo(-1), siguienteHermano(-1), primeraEntrada(-1),
+              maximaPuntuacion(-1) {}
+    };
+
+    struct Entrada {
+        int documento;            // -1 si se quitó
+        int puntuacion;
+        int nodo;                 // Nodo donde termina la clave
+        int siguiente;            // Siguiente entrada del mismo nodo
+        int anteriorDelDocumento; // Entrada anterior del mismo documento
+
+        Entrada(int _documento, int _puntuacion, int _nodo, int _siguiente, int _anteriorDelDocumento)
+            : documento(_documento), puntuacion(_puntuacion), nodo(_nodo), siguiente(_siguiente),
+              anteriorDelDocumento(_anteriorDelDocumento) {}
+    };
+
+    // Candidato de la búsqueda de primero el mejor: un nodo (cota de su subárbol) o un documento
+    struct Candidato {
+        int puntuacion;
+        int indice;
+        bool esDocumento;
+
+        Candidato(int _puntuacion, int _indice, bool _esDocumento)
+            : puntuacion(_puntuacion), indice(_indice), esDocumento(_esDocumento) {}
+
+        bool operator<(const Candidato& otro) const {
+            if (puntuacion != otro.puntuacion) {
+                return puntuacion < otro.puntuacion;
+            }
+            // A igual puntuación, primero los documentos
+            return !esDocumento && otro.esDocumento;
+        }
+    };
+
+    Lista<Nodo> nodos;
+    Lista<Entrada> entradas;
+    Lista<int> ultimaEntrada;     // Por documento: su última entrada (-1 si no tiene)
+
+    static char minuscula(char c) {
+        return static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+
+    // Buscar el hijo cuya etiqueta empieza por el carácter (-1 si no existe)
+    int buscarHijo(int nodo, char c) const {
+        char buscado = minuscula(c);
+        for (int hijo = nodos.obtener(nodo).primerHijo; hijo != -1; hijo = nodos.obtener(hijo).siguienteHermano) {
+            if (minuscula(nodos.obtener(hijo).etiqueta[0]) == buscado) {
+                return hijo;
+            }
+        }
+        return -1;
+    }
+
+    // Insertar una clave completa
+    void insertarClave(const VistaCadena& clave, int documento, int puntuacion) {
+        int nodo = 0;
+        int posicion = 0;
+
+        while (true) {
+            Nodo& actual = nodos.obtener(nodo);
+            actual.maximaPuntuacion = std::max(actual.maximaPuntuacion, puntuacion);
+
+            if (posicion == clave.obtenerLongitud()) {
+                while (ultimaEntrada.obtenerTamanio() <= documento) {
+                    ultimaEntrada.agregar(-1);
+                }
+                entradas.emplazar(documento, puntuacion, nodo, actual.primeraEntrada, ultimaEntrada.obtener(documento));
+                actual.primeraEntrada = entradas.obtenerTamanio() - 1;
+                ultimaEntrada.obtener(documento) = actual.primeraEntrada;
+                return;
+            }
+
+            int hijo = buscarHijo(nodo, clave[posicion]);
+            if (hijo == -1) {
+                // Nueva hoja con el resto de la clave
+                int longitudResto = clave.obtenerLongitud() - posicion;
+                nodos.emplazar(VistaCadena(clave.obtenerDatos() + posicion, longitudResto), nodo);
+                int hoja = nodos.obtenerTamanio() - 1;
+                nodos.obtener(hoja).siguienteHermano = nodos.obtener(nodo).primerHijo;
+                nodos.obtener(nodo).primerHijo = hoja;
+                nodo = hoja;
+                posicion = clave.obtenerLongitud();
+                continue;
+            }
+
+            // Longitud del prefijo común entre la etiqueta del hijo y el resto de la clave
+            VistaCadena etiqueta = nodos.obtener(hijo).etiqueta;
+            int comun = 1;
+            while (comun < etiqueta.obtenerLongitud() && posicion + comun < clave.obtenerLongitud() &&
+                   minuscula(etiqueta[comun]) == minuscula(clave[posicion + comun])) {
+                comun++;
+            }
+
+            if (comun < etiqueta.obtenerLongitud()) {
+                // Dividir la arista: el nuevo nodo intermedio ocupa el lugar del hijo
+                nodos.emplazar(VistaCadena(etiqueta.obtenerDatos(), comun), nodo);
+                int intermedio = nodos.obtenerTamanio() - 1;
+                Nodo& nuevo = nodos.obtener(intermedio);
+                Nodo& anterior = nodos.obtener(hijo);
+
+                anterior.padre = intermedio;
+                nuevo.primerHijo = hijo;
+                nuevo.siguienteHermano = anterior.siguienteHermano;
+                nuevo.maximaPuntuacion = anterior.maximaPuntuacion;
+                anterior.siguienteHermano = -1;
+                anterior.etiqueta = VistaCadena(etiqueta.obtenerDatos() + comun, etiqueta.obtenerLongitud() - comun);
+
+                // Reemplazar al hijo en la lista de hermanos del padre
+                if (nodos.obtener(nodo).primerHijo == hijo) {
+                    nodos.obtener(nodo).primerHijo = intermedio;
+                } else {
+                    int hermano = nodos.obtener(nodo).primerHijo;
+                    while (nodos.obtener(hermano).siguienteHermano != hijo) {
+                        hermano = nodos.obtener(hermano).siguienteHermano;
+                    }
+                    nodos.obtener(hermano).siguienteHermano = intermedio;
+                }
+
+                hijo = intermedio;
+            }
+
+            nodo = hijo;
+            posicion += comun;
+        }
+    }
+
+public:
+    // Constructor
+    TriePrefijos() {
+        vaciar();
+    }
+
+    // Indexar un texto: se inserta completo y desde el comienzo de cada palabra
+    // El texto debe seguir siendo válido mientras se use el árbol
+    void agregar(int documento, const VistaCadena& texto, int puntuacion) {
+        for (int i = 0; i < texto.obtenerLongitud(); i++) {
+            bool inicioPalabra = i == 0 || texto[i - 1] == ' ';
+            if (inicioPalabra && texto[i] != ' ') {
+                insertarClave(VistaCadena(texto.obtenerDatos() + i, texto.obtenerLongitud() - i),
+                              documento, puntuacion);
+            }
+        }
+    }
+
+    // Posición inicial (prefijo vacío)
+    Posicion raiz() const {
+        return Posicion();
+    }
+
+    // Extender el prefijo de una posición con un carácter reutilizando el nodo actual
+    // Devuelve false (y deja la posición inválida) si ningún texto continúa así
+    bool avanzar(Posicion& posicion, char c) const {
+        if (!posicion.esValida()) {
+            return false;
+        }
+
+        const Nodo& actual = nodos.obtener(posicion.nodo);
+        if (posicion.desplazamiento < actual.etiqueta.obtenerLongitud()) {
+            if (minuscula(actual.etiqueta[posicion.desplazamiento]) == minuscula(c)) {
+                posicion.desplazamiento++;
+                return true;
+            }
+        } else {
+            int hijo = buscarHijo(posicion.nodo, c);
+            if (hijo != -1) {
+                posicion.nodo = hijo;
+                posicion.desplazamiento = 1;
+                return true;
+            }
+        }
+
+        posicion.nodo = -1;
+        return false;
+    }
+
+    // Obtener los k documentos de mayor puntuación que continúan el prefijo, sin repetir
+    Lista<int> obtenerMejores(const Posicion& posicion, int k) const {
+        Lista<int> resultado;
+        if (!posicion.esValida() || k <= 0) {
+            return resultado;
+        }
+
+        ColaPrioridad<Candidato> frontera;
+        frontera.encolar(Candidato(nodos.obtener(posicion.nodo).maximaPuntuacion, posicion.nodo, false));
+
+        while (!frontera.estaVacia() && resultado.obtenerTamanio() < k) {
+            Candidato mejor = frontera.frente();
+            frontera.desencolar();
+
+            if (mejor.esDocumento) {
+                if (!resultado.contiene(mejor.indice)) {
+                    resultado.agregar(mejor.indice);
+                }
+                continue;
+            }
+
+            const Nodo& nodo = nodos.obtener(mejor.indice);
+            for (int e = nodo.primeraEntrada; e != -1; e = entradas.obtener(e).siguiente) {
+                if (entradas.obtener(e).documento != -1) {
+                    frontera.encolar(Candidato(entradas.obtener(e).puntuacion, entradas.obtener(e).documento, true));
+                }
+            }
+            for (int hijo = nodo.primerHijo; hijo != -1; hijo = nodos.obtener(hijo).siguienteHermano) {
+                frontera.encolar(Candidato(nodos.obtener(hijo).maximaPuntuacion, hijo, false));
+            }
+        }
+
+        return resultado;
+    }
+
+    // Subir la puntuación de todas las entradas de un documento y la cota de los nodos
+    // que las contienen; solo se recorren los ancestros cuya cota queda por debajo
+    void actualizarPuntuacion(int documento, int puntuacion) {
+        if (documento < 0 || documento >= ultimaEntrada.obtenerTamanio()) {
+            return;
+        }
+
+        for (int e = ultimaEntrada.obtener(documento); e != -1; e = entradas.obtener(e).anteriorDelDocumento) {
+            Entrada& entrada = entradas.obtener(e);
+            entrada.puntuacion = std::max(entrada.puntuacion, puntuacion);
+            for (int nodo = entrada.nodo; nodo != -1 && nodos.obtener(nodo).maximaPuntuacion < puntuacion;
+                 nodo = nodos.obtener(nodo).padre) {
+                nodos.obtener(nodo).maximaPuntuacion = puntuacion;
+            }
+        }
+    }
+
+    // Quitar todas las entradas de un documento en O(entradas del documento)
+    // Las entradas quitadas se marcan y siguen enlazadas en su nodo; la puntuación
+    // máxima de cada nodo sigue siendo una cota válida de su subárbol
+    void quitar(int documento) {
+        if (documento < 0 || documento >= ultimaEntrada.obtenerTamanio()) {
+            return;
+        }
+
+        for (int e = ultimaEntrada.obtener(documento); e != -1; e = entradas.obtener(e).anteriorDelDocumento) {
+            entradas.obtener(e).documento = -1;
+        }
+        ultimaEntrada.obtener(documento) = -1;
+    }
+
+    // Vaciar el árbol
+    void vaciar() {
+        nodos.vaciar();
+        entradas.vaciar();
+        ultimaEntrada.vaciar();
+        nodos.emplazar(VistaCadena(), -1);
+    }
+};
+
+/**
+ * @brief Algoritmos de ordenamiento
+ *
+ * Ordenamiento por mezcla estable sobre un arreglo de índices: los elementos no se
+ * copian al comparar y el comparador es un parámetro de plantilla, así que cada
+ * criterio se compila por separado en lugar de pasar por una llamada indirecta.
+ *
+ * Los criterios de obtenerPermutacion exponen dos funciones estáticas:
+ * comparar(a, b), de tres vías, y prefijo(a), un entero de 64 bits que respeta el orden
+ * (si prefijo(a) < prefijo(b) entonces a < b). Se ordenan pares (prefijo, índice)
+ * contiguos y solo se consulta el elemento cuando los prefijos empatan.
+ */
+template <typename T>
+class Ordenamiento {
+private:
+    static const int TAMANIO_TRAMO = 32;   // Tramos que se ordenan por inserción
+
+    // Índice con el prefijo de su clave de ordenamiento
+    struct EntradaOrden {
+        uint64_t prefijo;
+        int indice;
+    };
+
+    // Mezclar los tramos ordenados [inicio, medio) y [medio, fin) de origen en destino
+    // A igualdad gana el tramo izquierdo, lo que mantiene la estabilidad
+    template <typename E, typename Comparador>
+    static void mezclar(const E* origen, E* destino, int inicio, int medio, int fin, Comparador& comparador) {
+        int i = inicio;
+        int j = medio;
+        int k = inicio;
+
+        while (i < medio && j < fin) {
+            if (comparador(origen[j], origen[i])) {
+                destino[k++] = origen[j++];
+            } else {
+                destino[k++] = origen[i++];
+            }
+        }
+        while (i < medio) {
+            destino[k++] = origen[i++];
+        }
+        while (j < fin) {
+            destino[k++] = origen[j++];
+        }
+    }
+
+    // Ordenamiento por mezcla estable de un arreglo contiguo
+    template <typename E, typename Comparador>
+    static void ordenarEstable(Lista<E>& datos, Comparador comparador) {
+        int n = datos.obtenerTamanio();
+        E* elementos = datos.begin();
+
+        // Tramos cortos por inserción
+        for (int inicio = 0; inicio < n; inicio += TAMANIO_TRAMO) {
+            int fin = std::min(inicio + TAMANIO_TRAMO, n);
+            for (int i = inicio + 1; i < fin; i++) {
+                E actual = elementos[i];
+                int j = i;
+                while (j > inicio && comparador(actual, elementos[j - 1])) {
+                    elementos[j] = elementos[j - 1];
+                    j--;
+                }
+                elementos[j] = actual;
+            }
+        }
+
+        if (n <= TAMANIO_TRAMO) {
+            return;
+        }
+
+        // Mezclas de abajo hacia arriba alternando entre los dos arreglos
+        Lista<E> auxiliar(datos);
+        E* origen = datos.begin();
+        E* destino = auxiliar.begin();
+
+        for (int ancho = TAMANIO_TRAMO; ancho < n; ancho *= 2) {
+            for (int inicio = 0; inicio < n; inicio += 2 * ancho) {
+                int medio = std::min(inicio + ancho, n);
+                int fin = std::min(inicio + 2 * ancho, n);
+                mezclar(origen, destino, inicio, medio, fin, comparador);
+            }
+            std::swap(origen, destino);
+        }
+
+        if (origen != datos.begin()) {
+            std::move(origen, origen + n, datos.begin());
+        }
+    }
+
+public:
+    // Ordenar una lista de forma estable con un comparador (por defecto, de menor a mayor)
+    template <typename Comparador = std::less<T>>
+    static void ordenar(Lista<T>& lista, Comparador comparador = Comparador()) {
+        ordenarEstable(lista, comparador);
+    }
+
+    // Ordenar de forma estable un arreglo de índices sobre la lista de elementos
+    template <typename Comparador>
+    static void ordenarIndices(const Lista<T>& elementos, Lista<int>& indices, Comparador comparador) {
+        const T* base = elementos.begin();   // Acceso directo, sin comprobación de rango
+        ordenarEstable(indices, [base, &comparador](int a, int b) {
+            return comparador(base[a], base[b]);
+        });
+    }
+
+    // Obtener la permutación que ordena la lista de forma estable según el criterio
+    template <typename Criterio>
+    static Lista<int> obtenerPermutacion(const Lista<T>& elementos, Criterio, bool ascendente = true) {
+        int n = elementos.obtenerTamanio();
+        const T* base = elementos.begin();
+
+        Lista<EntradaOrden> entradas;
+        entradas.reservar(n);
+        for (int i = 0; i < n; i++) {
+            // En orden descendente se invierten los prefijos
+            uint64_t prefijo = Criterio::prefijo(base[i]);
+            entradas.agregar(EntradaOrden{ascendente ? prefijo : ~prefijo, i});
+        }
+
+        int signo = ascendente ? 1 : -1;
+        ordenarEstable(entradas, [base, signo](const EntradaOrden& a, const EntradaOrden& b) {
+            if (a.prefijo != b.prefijo) {
+                return a.prefijo < b.prefijo;
+            }
+            return signo * Criterio::comparar(base[a.indice], base[b.indice]) < 0;
+        });
+
+        Lista<int> permutacion;
+        permutacion.reservar(n);
+        for (const EntradaOrden& entrada : entradas) {
+            permutacion.agregar(entrada.indice);
+        }
+        return permutacion;
+    }
+};
+
+/**
+ * @brief Comparador por varios criterios: cada criterio solo desempata al anterior
+ *
+ * Cada criterio expone comparar(a, b), de tres vías, para no comparar dos veces el
+ * mismo campo, y prefijo(a) como indica Ordenamiento; el prefijo del conjunto es el
+ * del primer criterio. Por ejemplo,
+ * OrdenLexicografico<CompararArtista, CompararAlbum, CompararAnio>.
+ */
+template <typename... Criterios>
+struct OrdenLexicografico;
+
+template <typename Criterio>
+struct OrdenLexicografico<Criterio> {
+    template <typename T>
+    static int comparar(const T& a, const T& b) {
+        return Criterio::comparar(a, b);
+    }
+
+    template <typename T>
+    static uint64_t prefijo(const T& a) {
+        return Criterio::prefijo(a);
+    }
+
+    template <typename T>
+    bool operator()(const T& a, const T& b) const {
+        return comparar(a, b) < 0;
+    }
+};
+
+template <typename Criterio, typename... Resto>
+struct OrdenLexicografico<Criterio, Resto...> {
+    template <typename T>
+    static int comparar(const T& a, const T& b) {
+        int resultado = Criterio::comparar(a, b);
+        return resultado != 0 ? resultado : OrdenLexicografico<Resto...>::comparar(a, b);
+    }
+
+    template <typename T>
+    static uint64_t prefijo(const T& a) {
+        return Criterio::prefijo(a);
+    }
+
+    template <typename T>
+    bool operator()(const T& a, const T& b) const {
+        return comparar(a, b) < 0;
+    }
+};
+
+/**
+ * @brief Consulta de varios campos, por ejemplo "artist:queen year:1970..1980 genre:rock dur:<300"
+ *
+ * Cada término es un filtro y la consulta pide que se cumplan todos. Los textos se
+ * buscan como subcadena sin distinguir mayúsculas ni acentos, y las palabras sin campo
+ * se buscan en título, artista y álbum. Los números admiten un valor exacto, "a..b",
+ * "a..", "..b", "<n", "<=n", ">n" o ">=n"; las duraciones, además, "m:ss". Los valores
+ * con espacios van entre comillas: artist:"the moon". Un '-' delante niega el término:
+ * "genre:rock -genre:pop" pide rock que no sea pop.
+ */
+class ConsultaBiblioteca {
+public:
+    enum Campo {
+        CAMPO_TEXTO,      // Título, artista o álbum
+        CAMPO_TITULO,
+        CAMPO_ARTISTA,
+        CAMPO_ALBUM,
+        CAMPO_GENERO,
+        CAMPO_ANIO,
+        CAMPO_DURACION
+    };
+
+    // Un término de la consulta: texto normalizado o rango numérico cerrado
+    struct Filtro {
+        Campo campo;
+        std::string texto;
+        int minimo;
+        int maximo;
+        bool negado;        // La canción debe no cumplirlo
+
+        Filtro(Campo _campo, const std::string& _texto, int _minimo, int _maximo, bool _negado)
+            : campo(_campo), texto(_texto), minimo(_minimo), maximo(_maximo), negado(_negado) {}
+
+        bool esNumerico() const {
+            return campo == CAMPO_ANIO || campo == CAMPO_DURACION;
+        }
+    };
+
+private:
+    // Identificar el nombre de un campo (en inglés o en español)
+    static Campo identificarCampo(const std::string& nombre) {
+        std::string clave = Colacion::normalizar(nombre);
+
+        if (clave == "title" || clave == "titulo") return CAMPO_TITULO;
+        if (clave == "artist" || clave == "artista") return CAMPO_ARTISTA;
+        if (clave == "album") return CAMPO_ALBUM;
+        if (clave == "genre" || clave == "genero") return CAMPO_GENERO;
+        if (clave == "year" || clave == "anio" || clave == "ano") return CAMPO_ANIO;
+        if (clave == "dur" || clave == "duration" || clave == "duracion") return CAMPO_DURACION;
+
+        throw std::invalid_argument("Campo desconocido: " + nombre);
+    }
+
+    // Leer un número entero (o m:ss si se admiten minutos) que ocupa todo el texto
+    static int leerNumero(const std::string& texto, bool minutos) {
+        int valor = 0;
+        int segundos = -1;
+        bool hayDigitos = false;
+
+        for (size_t i = 0; i < texto.length(); i++) {
+            char c = texto[i];
+            if (c >= '0' && c <= '9') {
+                if (segundos >= 0) {
+                    segundos = segundos * 10 + (c - '0');
+                } else {
+                    valor = valor * 10 + (c - '0');
+                }
+                hayDigitos = true;
+                if (valor > 100000000 || segundos > 59) {
+                    throw std::invalid_argument("Número fuera de rango: " + texto);
+                }
+            } else if (c == ':' && minutos && segundos < 0 && hayDigitos) {
+                segundos = 0;
+            } else {
+                throw std::invalid_argument("Número inválido: " + texto);
+            }
+        }
+
+        if (!hayDigitos) {
+            throw std::invalid_argument("Número inválido: " + texto);
+        }
+        return segundos >= 0 ? valor * 60 + segundos : valor;
+    }
+
+    // Convertir el valor de un filtro numérico en un rango cerrado [minimo, maximo]
+    static void leerRango(const std::string& valor, bool minutos, int& minimo, int& maximo) {
+        minimo = std::numeric_limits<int>::min();
+        maximo = std::numeric_limits<int>::max();
+
+        size_t puntos = valor.find("..");
+        if (puntos != std::string::npos) {
+            if (puntos > 0) {
+                minimo = leerNumero(valor.substr(0, puntos), minutos);
+            }
+            if (puntos + 2 < valor.length()) {
+                maximo = leerNumero(valor.substr(puntos + 2), minutos);
+            }
+        } else if (valor.compare(0, 2, "<=") == 0) {
+            maximo = leerNumero(valor.substr(2), minutos);
+        } else if (valor.compare(0, 2, ">=") == 0) {
+            minimo = leerNumero(valor.substr(2), minutos);
+        } else if (valor.compare(0, 1, "<") == 0) {
+            maximo = leerNumero(valor.substr(1), minutos) - 1;
+        } else if (valor.compare(0, 1, ">") == 0) {
+            minimo = leerNumero(valor.substr(1), minutos) + 1;
+        } else {
+            minimo = maximo = leerNumero(valor, minutos);
+        }
+    }
+
+public:
+    // Analizar el texto de una consulta; lanza std::invalid_argument si no es válida
+    static Lista<Filtro> analizar(const std::string& consulta) {
+        Lista<Filtro> filtros;
+        size_t i = 0;
+
+        while (i < consulta.length()) {
+            if (std::isspace(static_cast<unsigned char>(consulta[i]))) {
+                i++;
+                continue;
+            }
+
+            bool negado = consulta[i] == '-';
+            if (negado) {
+                i++;
+            }
+
+            // Nombre del campo: lo que precede a ':' dentro del mismo término
+            Campo campo = CAMPO_TEXTO;
+            size_t fin = i;
+            while (fin < consulta.length() && consulta[fin] != ':' && consulta[fin] != '"' &&
+                   !std::isspace(static_cast<unsigned char>(consulta[fin]))) {
+                fin++;
+            }
+            if (fin < consulta.length() && consulta[fin] == ':' && fin > i) {
+                campo = identificarCampo(consulta.substr(i, fin - i));
+                i = fin + 1;
+            }
+
+            // Valor: entre comillas o hasta el siguiente espacio
+            std::string valor;
+            if (i < consulta.length() && consulta[i] == '"') {
+                size_t cierre = consulta.find('"', i + 1);
+                if (cierre == std::string::npos) {
+                    throw std::invalid_argument("Falta cerrar las comillas");
+                }
+                valor = consulta.substr(i + 1, cierre - i - 1);
+                i = cierre + 1;
+            } else {
+                fin = i;
+                while (fin < consulta.length() && !std::isspace(static_cast<unsigned char>(consulta[fin]))) {
+                    fin++;
+                }
+                valor = consulta.substr(i, fin - i);
+                i = fin;
+            }
+
+            if (valor.empty()) {
+                throw std::invalid_argument("Falta el valor de un filtro");
+            }
+
+            if (campo == CAMPO_ANIO || campo == CAMPO_DURACION) {
+                int minimo;
+                int maximo;
+                leerRango(valor, campo == CAMPO_DURACION, minimo, maximo);
+                filtros.emplazar(campo, std::string(), minimo, maximo, negado);
+            } else {
+                filtros.emplazar(campo, Colacion::normalizar(valor), 0, 0, negado);
+            }
+        }
+
+        return filtros;
+    }
+};
+
+/**
+ * @brief Permutación pseudoaleatoria de [0, n) determinada por una semilla
+ *
+ * Es una red de Feistel sobre el menor dominio de 2^(2b) valores que cubre n; los
+ * resultados fuera de rango se vuelven a cifrar hasta caer dentro (a lo sumo unas
+ * cuatro vueltas en promedio). Así cada posición da su elemento en O(1), el elemento
+ * da su posición con la red inversa, y la memoria no depende de n.
+ */
+class PermutacionAleatoria {
+private:
+    static const int RONDAS = 4;
+
+    int tamanio;
+    int bitsMitad;
+    uint32_t mascaraMitad;
+    uint32_t claves[RONDAS];
+
+    uint32_t funcionRonda(uint32_t mitad, int ronda) const {
+        return FuncionHash<int>::calcular(static_cast<int>(mitad ^ claves[ronda])) & mascaraMitad;
+    }
+
+    uint32_t cifrar(uint32_t valor) const {
+        uint32_t izquierda = valor >> bitsMitad;
+        uint32_t derecha = valor & mascaraMitad;
+        for (int ronda = 0; ronda < RONDAS; ronda++) {
+            uint32_t siguiente = izquierda ^ funcionRonda(derecha, ronda);
+            izquierda = derecha;
+            derecha = siguiente;
+        }
+        return (izquierda << bitsMitad) | derecha;
+    }
+
+    uint32_t descifrar(uint32_t valor) const {
+        uint32_t izquierda = valor >> bitsMitad;
+        uint32_t derecha = valor & mascaraMitad;
+        for (int ronda = RONDAS - 1; ronda >= 0; ronda--) {
+            uint32_t anterior = derecha ^ funcionRonda(izquierda, ronda);
+            derecha = izquierda;
+            izquierda = anterior;
+        }
+        return (izquierda << bitsMitad) | derecha;
+    }
+
+public:
+    // Constructor
+    explicit PermutacionAleatoria(int n = 0, uint64_t semilla = 0) {
+        reiniciar(n, semilla);
+    }
+
+    // Elegir otra permutación de [0, n)
+    void reiniciar(int n, uint64_t semilla) {
+        tamanio = std::max(0, n);
+
+        bitsMitad = 1;
+        while ((1LL << (2 * bitsMitad)) < tamanio) {
+            bitsMitad++;
+        }
+        mascaraMitad = (1U << bitsMitad) - 1;
+
+        // Claves de ronda derivadas de la semilla (splitmix64)
+        for (int ronda = 0; ronda < RONDAS; ronda++) {
+            semilla += 0x9e3779b97f4a7c15ULL;
+            uint64_t z = semilla;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+            claves[ronda] = static_cast<uint32_t>(z ^ (z >> 31));
+        }
+    }
+
+    // Elemento en la posición indicada
+    int obtener(int posicion) const {
+        if (posicion < 0 || posicion >= tamanio) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+
+        uint32_t valor = static_cast<uint32_t>(posicion);
+        do {
+            valor = cifrar(valor);
+        } while (valor >= static_cast<uint32_t>(tamanio));
+        return static_cast<int>(valor);
+    }
+
+    // Posición del elemento indicado
+    int posicionDe(int elemento) const {
+        if (elemento < 0 || elemento >= tamanio) {
+            return -1;
+        }
+
+        uint32_t valor = static_cast<uint32_t>(elemento);
+        do {
+            valor = descifrar(valor);
+        } while (valor >= static_cast<uint32_t>(tamanio));
+        return static_cast<int>(valor);
+    }
+
+    int obtenerTamanio() const {
+        return tamanio;
+    }
+};
+
+/**
+ * @brief Muestreo ponderado con tabla de alias (método de Vose)
+ *
+ * La tabla se construye en O(n) sobre una cota de cada peso (el peso por la holgura) y
+ * cada extracción elige una columna y una moneda en O(1), aceptando el resultado con
+ * probabilidad peso / cota. Cambiar un peso sin pasar su cota es O(1); si la pasa, o si
+ * los pesos quedan muy por debajo de las cotas, la siguiente extracción reconstruye.
+ */
+class TablaAlias {
+private:
+    Lista<double> pesos;
+    Lista<double> cotas;           // Las de la última construcción
+    Lista<double> probabilidades;  // Probabilidad de quedarse con la propia columna
+    Lista<int> alias;
+    double sumaPesos;
+    double sumaCotas;
+    double holgura;
+    bool desactualizada;
+    uint64_t estado;
+
+    // Real uniforme en [0, 1) (xorshift64*)
+    double siguienteReal() {
+        estado ^= estado >> 12;
+        estado ^= estado << 25;
+        estado ^= estado >> 27;
+        return static_cast<double>((estado * 0x2545f4914f6cdd1dULL) >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    void reconstruir() {
+        int n = pesos.obtenerTamanio();
+
+        sumaPesos = 0.0;
+        sumaCotas = 0.0;
+        for (int i = 0; i < n; i++) {
+            sumaPesos += pesos.obtener(i);
+            cotas.obtener(i) = pesos.obtener(i) * holgura;
+            sumaCotas += cotas.obtener(i);
+        }
+        desactualizada = false;
+        if (sumaCotas <= 0.0) {
+            return;
+        }
+
+        // Columnas con menos y con más del promedio; las grandes rellenan a las pequeñas
+        Lista<int> pequenias;
+        Lista<int> grandes;
+        for (int i = 0; i < n; i++) {
+            probabilidades.obtener(i) = cotas.obtener(i) * n / sumaCotas;
+            alias.obtener(i) = i;
+            if (probabilidades.obtener(i) < 1.0) {
+                pequenias.agregar(i);
+            } else {
+                grandes.agregar(i);
+            }
+        }
+
+        while (pequenias.obtenerTamanio() > 0 && grandes.obtenerTamanio() > 0) {
+            int pequenia = pequenias.obtener(pequenias.obtenerTamanio() - 1);
+            pequenias.eliminar(pequenias.obtenerTamanio() - 1);
+            int grande = grandes.obtener(grandes.obtenerTamanio() - 1);
+
+            alias.obtener(pequenia) = grande;
+            probabilidades.obtener(grande) -= 1.0 - probabilidades.obtener(pequenia);
+            if (probabilidades.obtener(grande) < 1.0) {
+                grandes.eliminar(grandes.obtenerTamanio() - 1);
+                pequenias.agregar(grande);
+            }
+        }
+
+        // Lo que queda vale 1 salvo por errores de redondeo
+        for (int i : grandes) {
+            probabilidades.obtener(i) = 1.0;
+        }
+        for (int i : pequenias) {
+            probabilidades.obtener(i) = 1.0;
+        }
+    }
+
+public:
+    // Constructor: la holgura debe cubrir cuánto puede crecer un peso entre construcciones
+    explicit TablaAlias(double _holgura = 1.0)
+        : sumaPesos(0.0), sumaCotas(0.0), holgura(std::max(1.0, _holgura)), desactualizada(false), estado(1) {}
+
+    // Empezar con n pesos nulos
+    void reiniciar(int n, uint64_t semilla) {
+        pesos.vaciar();
+        cotas.vaciar();
+        probabilidades.vaciar();
+        alias.vaciar();
+        for (int i = 0; i < n; i++) {
+            pesos.agregar(0.0);
+            cotas.agregar(0.0);
+            probabilidades.agregar(0.0);
+            alias.agregar(i);
+        }
+
+        sumaPesos = 0.0;
+        sumaCotas = 0.0;
+        desactualizada = true;
+        estado = semilla * 0x9e3779b97f4a7c15ULL + 1;   // Nunca cero para xorshift
+        if (estado == 0) {
+            estado = 1;
+        }
+    }
+
+    void establecerPeso(int indice, double peso) {
+        sumaPesos += peso - pesos.obtener(indice);
+        pesos.obtener(indice) = peso;
+        if (peso > cotas.obtener(indice)) {
+            desactualizada = true;
+        }
+    }
+
+    double obtenerPeso(int indice) const {
+        return pesos.obtener(indice);
+    }
+
+    double obtenerSumaPesos() const {
+        return sumaPesos;
+    }
+
+    // Elegir un índice con probabilidad proporcional a su peso; -1 si todos son nulos
+    int muestrear() {
+        if (desactualizada || sumaPesos * 2.0 * holgura < sumaCotas) {
+            reconstruir();
+        }
+        if (sumaPesos <= 0.0) {
+            return -1;
+        }
+
+        int n = pesos.obtenerTamanio();
+        while (true) {
+            int columna = static_cast<int>(siguienteReal() * n);
+            int indice = siguienteReal() < probabilidades.obtener(columna) ? columna : alias.obtener(columna);
+            if (siguienteReal() * cotas.obtener(indice) < pesos.obtener(indice)) {
+                return indice;
+            }
+        }
+    }
+
+    int obtenerTamanio() const {
+        return pesos.obtenerTamanio();
+    }
+};
+
+// ==================== MODELOS ====================
+
+/**
+ * @brief Diccionario de géneros: asigna a cada nombre un identificador entero compacto
+ */
+class DiccionarioGeneros {
+private:
+    Lista<VistaCadena> nombres;                     // Nombre de cada identificador
+    TablaHash<VistaCadena, int> identificadores;    // Identificador de cada nombre
+
+public:
+    // Buscar el identificador de un género (-1 si no existe)
+    int buscar(const VistaCadena& nombre) const {
+        const int* id = identificadores.buscar(nombre);
+        return id != nullptr ? *id : -1;
+    }
+
+    // Agregar un género y devolver su identificador
+    // El texto del nombre debe seguir siendo válido mientras se use el diccionario
+    int agregar(const VistaCadena& nombre) {
+        int id = buscar(nombre);
+        if (id != -1) {
+            return id;
+        }
+
+        id = nombres.obtenerTamanio();
+        nombres.agregar(nombre);
+        identificadores.insertar(nombre, id);
+        return id;
+    }
+
+    // Obtener el nombre de un identificador
+    VistaCadena obtenerNombre(int id) const {
+        return nombres.obtener(id);
+    }
+
+    // Obtener número de géneros
+    int obtenerTamanio() const {
+        return nombres.obtenerTamanio();
+    }
+
+    // Vaciar el diccionario
+    void vaciar() {
+        nombres.vaciar();
+        identificadores.vaciar();
+    }
+};
+
+/**
+ * @brief Vista sobre la lista de géneros de una canción
+ *
+ * Los géneros se guardan como identificadores de 32 bits consecutivos que se
+ * resuelven con el diccionario de géneros del reproductor.
+ */
+class VistaGeneros {
+private:
+    const char* ids;                          // Primer identificador
+    int cantidad;
+    const DiccionarioGeneros* diccionario;
+
+public:
+    // Constructor por defecto (sin géneros)
+    VistaGeneros() : ids(nullptr), cantidad(0), diccionario(nullptr) {}
+
+    // Constructor a partir de un bloque de identificadores
+    VistaGeneros(const char* _ids, int _cantidad, const DiccionarioGeneros* _diccionario)
+        : ids(_ids), cantidad(_cantidad), diccionario(_diccionario) {}
+
+    // Obtener el identificador del género en una posición específica
+    int obtenerId(int indice) const {
+        if (indice < 0 || indice >= cantidad) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+        return CodificacionBinaria::leerEntero32(ids + 4 * indice);
+    }
+
+    // Obtener el nombre del género en una posición específica
+    VistaCadena obtener(int indice) const {
+        return diccionario->obtenerNombre(obtenerId(indice));
+    }
+
+    // Verificar si contiene un género
+    bool contiene(const VistaCadena& genero) const {
+        if (cantidad == 0) {
+            return false;
+        }
+
+        int id = diccionario->buscar(genero);
+        for (int i = 0; i < cantidad && id != -1; i++) {
+            if (obtenerId(i) == id) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Obtener número de géneros
+    int obtenerTamanio() const {
+        return cantidad;
+    }
+
+    // Verificar si no hay géneros
+    bool estaVacia() const {
+        return cantidad == 0;
+    }
+};
+
+/**
+ * @brief Estructura que representa una canción
+ *
+ * Los textos son vistas sobre la biblioteca mapeada en memoria (o sobre el
+ * almacén de texto del reproductor), así que copiar una canción no copia cadenas.
+ */
+struct Cancion {
+    VistaCadena titulo;           // Título de la canción
+    VistaCadena artista;          // Artista o intérprete
+    VistaCadena album;            // Álbum al que pertenece
+    int anio;                     // Año de lanzamiento
+    int duracion;                 // Duración en segundos
+    VistaCadena ruta;             // Ruta del archivo de audio
+    int reproducciones;           // Veces que se ha reproducido
+    int saltos;                   // Veces que se saltó en esta sesión (no se guarda)
+    bool eliminada;               // Quitada de la biblioteca: su identificador no se reutiliza
+    VistaGeneros generos;         // Géneros musicales
+
+    // Claves de colación (sin mayúsculas ni acentos) para ordenar y buscar;
+    // las calcula el reproductor al cargar o agregar la canción
+    VistaCadena claveTitulo;
+    VistaCadena claveArtista;
+    VistaCadena claveAlbum;
+
+    // Constructor por defecto
+    Cancion() : anio(0), duracion(0), reproducciones(0), saltos(0), eliminada(false) {}
+
+    // Constructor con parámetros
+    Cancion(const VistaCadena& _titulo, const VistaCadena& _artista, const VistaCadena& _album,
+            int _anio, int _duracion)
+        : titulo(_titulo), artista(_artista), album(_album), anio(_anio), duracion(_duracion),
+          reproducciones(0), saltos(0), eliminada(false) {}
+
+    // Métodos de comparación para ordenamiento
+    bool compararPorTitulo(const Cancion& otra) const {
+        return claveTitulo < otra.claveTitulo;
+    }
+
+    bool compararPorArtista(const Cancion& otra) const {
+        return claveArtista < otra.claveArtista;
+    }
+
+    bool compararPorAlbum(const Cancion& otra) const {
+        return claveAlbum < otra.claveAlbum;
+    }
+
+    bool compararPorAnio(const Cancion& otra) const {
+        return anio < otra.anio;
+    }
+
+    bool compararPorDuracion(const Cancion& otra) const {
+        return duracion < otra.duracion;
+    }
+
+    // Operadores de comparación
+    bool operator==(const Cancion& otra) const {
+        return titulo == otra.titulo && artista == otra.artista;
+    }
+
+    bool operator!=(const Cancion& otra) const {
+        return !(*this == otra);
+    }
+
+    // Método para formatear la duración
+    std::string obtenerDuracionFormateada() const {
+        int minutos = duracion / 60;
+        int segundos = duracion % 60;
+        char buffer[10];
+        sprintf(buffer, "%02d:%02d", minutos, segundos);
+        return std::string(buffer);
+    }
+};
+
+/**
+ * @brief Comparadores de canciones para Ordenamiento y OrdenLexicografico
+ */
+inline uint64_t prefijoEntero(int valor) {
+    // Desplazar el bit de signo para que el orden sin signo coincida con el de int
+    return static_cast<uint64_t>(static_cast<uint32_t>(valor) ^ 0x80000000u) << 32;
+}
+
+struct CompararTitulo {
+    static int comparar(const Cancion& a, const Cancion& b) {
+        return a.claveTitulo.comparar(b.claveTitulo);
+    }
+
+    static uint64_t prefijo(const Cancion& a) {
+        return a.claveTitulo.obtenerPrefijo();
+    }
+
+    bool operator()(const Cancion& a, const Cancion& b) const {
+        return a.compararPorTitulo(b);
+    }
+};
+
+struct CompararArtista {
+    static int comparar(const Cancion& a, const Cancion& b) {
+        return a.claveArtista.comparar(b.claveArtista);
+    }
+
+    static uint64_t prefijo(const Cancion& a) {
+        return a.claveArtista.obtenerPrefijo();
+    }
+
+    bool operator()(const Cancion& a, const Cancion& b) const {
+        return a.compararPorArtista(b);
+    }
+};
+
+struct CompararAlbum {
+    static int comparar(const Cancion& a, const Cancion& b) {
+        return a.claveAlbum.comparar(b.claveAlbum);
+    }
+
+    static uint64_t prefijo(const Cancion& a) {
+        return a.claveAlbum.obtenerPrefijo();
+    }
+
+    bool operator()(const Cancion& a, const Cancion& b) const {
+        return a.compararPorAlbum(b);
+    }
+};
+
+struct CompararAnio {
+    static int comparar(const Cancion& a, const Cancion& b) {
+        return a.anio < b.anio ? -1 : (a.anio > b.anio ? 1 : 0);
+    }
+
+    static uint64_t prefijo(const Cancion& a) {
+        return prefijoEntero(a.anio);
+    }
+
+    bool operator()(const Cancion& a, const Cancion& b) const {
+        return a.compararPorAnio(b);
+    }
+};
+
+struct CompararDuracion {
+    static int comparar(const Cancion& a, const Cancion& b) {
+        return a.duracion < b.duracion ? -1 : (a.duracion > b.duracion ? 1 : 0);
+    }
+
+    static uint64_t prefijo(const Cancion& a) {
+        return prefijoEntero(a.duracion);
+    }
+
+    bool operator()(const Cancion& a, const Cancion& b) const {
+        return a.compararPorDuracion(b);
+    }
+};
+
+/**
+ * @brief Estructura que representa una lista de reproducción
+ */
+struct ListaReproduccion {
+    std::string nombre;           // Nombre de la lista de reproducción
+    std::string descripcion;      // Descripción opcional
+    Lista<int> canciones;         // Índices de canciones en la biblioteca
+
+    // Constructor por defecto
+    ListaReproduccion() : nombre("Nueva Lista"), descripcion("") {}
+
+    // Constructor con nombre
+    ListaReproduccion(const std::string& _nombre) : nombre(_nombre), descripcion("") {}
+
+    // Constructor completo
+    ListaReproduccion(const std::string& _nombre, const std::string& _descripcion) :
+        nombre(_nombre), descripcion(_descripcion) {}
+
+    // Agrega una canción a la lista de reproducción
+    bool agregarCancion(int indiceCancion) {
+        if (canciones.contiene(indiceCancion)) {
+            return false;
+        }
+
+        canciones.agregar(indiceCancion);
+        return true;
+    }
+
+    // Elimina una canción de la lista de reproducción
+    bool eliminarCancion(int indiceCancion) {
+        int posicion = canciones.buscar(indiceCancion);
+        if (posicion == -1) {
+            return false;
+        }
+
+        canciones.eliminar(posicion);
+        return true;
+    }
+
+    // Verifica si la lista contiene una canción específica
+    bool contieneCancion(int indiceCancion) const {
+        return canciones.contiene(indiceCancion);
+    }
+
+    // Obtiene el número de canciones en la lista
+    int obtenerNumCanciones() const {
+        return canciones.obtenerTamanio();
+    }
+
+    // Vacía la lista de reproducción
+    void vaciar() {
+        canciones.vaciar();
+    }
+};
+
+// ==================== PERSISTENCIA ====================
+
+/**
+ * @brief Archivo proyectado en memoria en modo de solo lectura
+ */
+class ArchivoMapeado {
+private:
+    const char* datos;
+    size_t tamanio;
+#ifdef _WIN32
+    HANDLE archivo;
+    HANDLE mapeo;
+#else
+    int descriptor;
+#endif
+
+public:
+    // Constructor
+#ifdef _WIN32
+    ArchivoMapeado() : datos(nullptr), tamanio(0), archivo(INVALID_HANDLE_VALUE), mapeo(nullptr) {}
+#else
+    ArchivoMapeado() : datos(nullptr), tamanio(0), descriptor(-1) {}
+#endif
+
+    // Destructor
+    ~ArchivoMapeado() {
+        cerrar();
+    }
+
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+
+    // Proyectar un archivo completo; falla si no existe o está vacío
+    bool abrir(const std::string& ruta) {
+        cerrar();
+
+#ifdef _WIN32
+        archivo = CreateFileA(ruta.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (archivo == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER tamanioArchivo;
+        if (!GetFileSizeEx(archivo, &tamanioArchivo) || tamanioArchivo.QuadPart <= 0) {
+            cerrar();
+            return false;
+        }
+
+        mapeo = CreateFileMappingA(archivo, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapeo == nullptr) {
+            cerrar();
+            return false;
+        }
+
+        void* vista = MapViewOfFile(mapeo, FILE_MAP_READ, 0, 0, 0);
+        if (vista == nullptr) {
+            cerrar();
+            return false;
+        }
+
+        datos = static_cast<const char*>(vista);
+        tamanio = static_cast<size_t>(tamanioArchivo.QuadPart);
+#else
+        descriptor = open(ruta.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            return false;
+        }
+
+        struct stat informacion;
+        if (fstat(descriptor, &informacion) != 0 || informacion.st_size <= 0) {
+            cerrar();
+            return false;
+        }
+
+        size_t tamanioArchivo = static_cast<size_t>(informacion.st_size);
+        void* vista = mmap(nullptr, tamanioArchivo, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        if (vista == MAP_FAILED) {
+            cerrar();
+            return false;
+        }
+
+        // El cargador recorre el archivo de principio a fin una sola vez
+        madvise(vista, tamanioArchivo, MADV_SEQUENTIAL);
+
+        datos = static_cast<const char*>(vista);
+        tamanio = tamanioArchivo;
+#endif
+        return true;
+    }
+
+    // Obtener tamaño y fecha de última modificación de un archivo sin abrirlo
+    static bool obtenerFirma(const std::string& ruta, int64_t& tamanio, int64_t& modificacion) {
+#ifdef _WIN32
+        WIN32_FILE_ATTRIBUTE_DATA atributos;
+        if (!GetFileAttributesExA(ruta.c_str(), GetFileExInfoStandard, &atributos)) {
+            return false;
+        }
+        tamanio = static_cast<int64_t>((static_cast<uint64_t>(atributos.nFileSizeHigh) << 32) |
+                                       atributos.nFileSizeLow);
+        modificacion = static_cast<int64_t>((static_cast<uint64_t>(atributos.ftLastWriteTime.dwHighDateTime) << 32) |
+                                            atributos.ftLastWriteTime.dwLowDateTime);
+#else
+        struct stat informacion;
+        if (stat(ruta.c_str(), &informacion) != 0) {
+            return false;
+        }
+        tamanio = static_cast<int64_t>(informacion.st_size);
+        modificacion = static_cast<int64_t>(informacion.st_mtime);
+#endif
+        return true;
+    }
+
+    // Deshacer la proyección y cerrar el archivo
+    void cerrar() {
+#ifdef _WIN32
+        if (datos != nullptr) {
+            UnmapViewOfFile(datos);
+        }
+        if (mapeo != nullptr) {
+            CloseHandle(mapeo);
+            mapeo = nullptr;
+        }
+        if (archivo != INVALID_HANDLE_VALUE) {
+            CloseHandle(archivo);
+            archivo = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (datos != nullptr) {
+            munmap(const_cast<char*>(datos), tamanio);
+        }
+        if (descriptor >= 0) {
+            ::close(descriptor);
+            descriptor = -1;
+        }
+#endif
+        datos = nullptr;
+        tamanio = 0;
+    }
+
+    // Obtener puntero al inicio del archivo
+    const char* obtenerDatos() const {
+        return datos;
+    }
+
+    // Obtener tamaño del archivo en bytes
+    size_t obtenerTamanio() const {
+        return tamanio;
+    }
+
+    // Verificar si hay un archivo proyectado
+    bool estaAbierto() const {
+        return datos != nullptr;
+    }
+};
+
+/**
+ * @brief Cursor de lectura con verificación de límites sobre un bloque de bytes
+ */
+class LectorBinario {
+private:
+    const char* actual;
+    const char* fin;
+
+public:
+    // Constructor
+    LectorBinario(const char* _inicio, size_t _tamanio) : actual(_inicio), fin(_inicio + _tamanio) {}
+
+    // Leer un entero de 32 bits
+    int leerEntero() {
+        if (fin - actual < 4) {
+            throw std::runtime_error("Fin de archivo inesperado");
+        }
+
+        int valor = CodificacionBinaria::leerEntero32(actual);
+        actual += 4;
+        return valor;
+    }
+
+    // Leer una cadena con prefijo de longitud sin copiarla
+    VistaCadena leerCadena() {
+        int longitud = leerEntero();
+        if (longitud < 0 || fin - actual < longitud) {
+            throw std::runtime_error("Cadena fuera de los límites del archivo");
+        }
+
+        VistaCadena cadena(actual, longitud);
+        actual += longitud;
+        return cadena;
+    }
+
+    // Obtener la posición actual
+    const char* obtenerPosicion() const {
+        return actual;
+    }
+};
+
+/**
+ * @brief Registro de una canción tal como aparece en library.dat
+ */
+struct RegistroLegado {
+    VistaCadena titulo;
+    VistaCadena artista;
+    VistaCadena album;
+    int anio;
+    int duracion;
+    VistaCadena ruta;
+    int reproducciones;
+    VistaCadena bloqueGeneros;    // Géneros con prefijo de longitud, uno tras otro
+    int numGeneros;
+
+    RegistroLegado() : anio(0), duracion(0), reproducciones(0), numGeneros(0) {}
+};
+
+/**
+ * @brief Lector secuencial del formato original de library.dat
+ *
+ * Enteros de 32 bits little-endian y cadenas precedidas por su longitud:
+ *   cantidad de canciones
+ *   por canción: id, reproducciones, título, artista, álbum, año, duración,
+ *                ruta, cantidad de géneros, géneros
+ *
+ * Los registros solo pueden recorrerse en orden; se usa para migrar al formato columnar.
+ */
+class LectorBibliotecaLegada {
+private:
+    LectorBinario lector;
+    int cantidad;
+    int leidos;
+
+public:
+    // Constructor
+    explicit LectorBibliotecaLegada(const ArchivoMapeado& archivo)
+        : lector(archivo.obtenerDatos(), archivo.obtenerTamanio()), cantidad(0), leidos(0) {
+        cantidad = lector.leerEntero();
+        if (cantidad < 0) {
+            throw std::runtime_error("Cantidad de canciones inválida");
+        }
+    }
+
+    // Obtener la cantidad de canciones declarada en la cabecera
+    int obtenerCantidad() const {
+        return cantidad;
+    }
+
+    // Leer el siguiente registro; devuelve false al terminar
+    bool siguiente(RegistroLegado& registro) {
+        if (leidos >= cantidad) {
+            return false;
+        }
+
+        lector.leerEntero();  // id: la posición en la biblioteca cumple esa función
+        registro.reproducciones = lector.leerEntero();
+        registro.titulo = lector.leerCadena();
+        registro.artista = lector.leerCadena();
+        registro.album = lector.leerCadena();
+        registro.anio = lector.leerEntero();
+        registro.duracion = lector.leerEntero();
+        registro.ruta = lector.leerCadena();
+
+        registro.numGeneros = lector.leerEntero();
+        if (registro.numGeneros < 0) {
+            throw std::runtime_error("Cantidad de géneros inválida");
+        }
+
+        const char* inicioGeneros = lector.obtenerPosicion();
+        for (int j = 0; j < registro.numGeneros; j++) {
+            lector.leerCadena();
+        }
+        registro.bloqueGeneros = VistaCadena(inicioGeneros,
+                                             static_cast<int>(lector.obtenerPosicion() - inicioGeneros));
+
+        leidos++;
+        return true;
+    }
+};
+
+/**
+ * @brief Biblioteca en formato columnar versionado (.lmpb) proyectada en memoria
+ *
+ * Cabecera (enteros de 32 bits little-endian):
+ *   "LMPB", versión, cantidad de canciones, cantidad de géneros, cantidad de columnas,
+ *   tamaño y fecha de modificación del library.dat de origen (64 bits cada uno),
+ *   y por columna su desplazamiento y tamaño dentro del archivo.
+ *
+ * Columnas (alineadas a 4 bytes):
+ *   - Texto (título, artista, álbum, ruta, nombres de género): tabla de
+ *     desplazamientos de n + 1 entradas seguida de los bytes concatenados.
+ *   - Enteros (año, duración, reproducciones): un valor por canción.
+ *   - Géneros: tabla de desplazamientos de n + 1 entradas seguida de los
+ *     identificadores de género de todas las canciones.
+ *
+ * Las tablas de desplazamientos permiten leer cualquier campo de cualquier
+ * registro con un acceso directo, y un recorrido por año o duración solo toca
+ * la columna correspondiente.
+ */
+class BibliotecaColumnar {
+public:
+    enum Columna {
+        COLUMNA_TITULO,
+        COLUMNA_ARTISTA,
+        COLUMNA_ALBUM,
+        COLUMNA_RUTA,
+        COLUMNA_ANIO,
+        COLUMNA_DURACION,
+        COLUMNA_REPRODUCCIONES,
+        COLUMNA_GENEROS,
+        COLUMNA_NOMBRES_GENERO,
+        NUM_COLUMNAS
+    };
+
+    static const int VERSION = 2;
+    static const int INICIO_COLUMNAS = 36;
+    static const int TAMANIO_CABECERA = INICIO_COLUMNAS + 8 * NUM_COLUMNAS;
+
+private:
+    struct Seccion {
+        const char* datos;
+        int tamanio;
+    };
+
+    Seccion secciones[NUM_COLUMNAS];
+    int numCanciones;
+    int numGeneros;
+
+    // Entero en la posición indicada de una sección
+    int leerEntero(Columna columna, int posicion) const {
+        return CodificacionBinaria::leerEntero32(secciones[columna].datos + 4 * posicion);
+    }
+
+    // Verificar que una tabla de desplazamientos sea creciente y quepa en su sección
+    void validarTabla(Columna columna, int entradas, int tamanioElemento) const {
+        // Comparar por división evita desbordar 4 * (entradas + 1) con cabeceras corruptas
+        if (entradas > secciones[columna].tamanio / 4 - 1) {
+            throw std::runtime_error("Columna truncada");
+        }
+        int inicioDatos = 4 * (entradas + 1);
+
+        int anterior = 0;
+        for (int i = 0; i <= entradas; i++) {
+            int actual = leerEntero(columna, i);
+            if (actual < anterior) {
+                throw std::runtime_error("Tabla de desplazamientos inválida");
+            }
+            anterior = actual;
+        }
+
+        if (static_cast<int64_t>(anterior) * tamanioElemento > secciones[columna].tamanio - inicioDatos) {
+            throw std::runtime_error("Columna truncada");
+        }
+    }
+
+public:
+    // Constructor
+    BibliotecaColumnar() : numCanciones(0), numGeneros(0) {
+        cerrar();
+    }
+
+    // Verificar si un archivo está en formato columnar
+    static bool esFormatoColumnar(const ArchivoMapeado& archivo) {
+        return archivo.obtenerTamanio() >= 4 && std::memcmp(archivo.obtenerDatos(), "LMPB", 4) == 0;
+    }
+
+    // Verificar que un archivo columnar sea de esta versión y se haya generado a partir
+    // del estado actual de su library.dat de origen
+    static bool correspondeAOrigen(const ArchivoMapeado& archivo, const std::string& rutaOrigen) {
+        if (!esFormatoColumnar(archivo) || archivo.obtenerTamanio() < static_cast<size_t>(TAMANIO_CABECERA)) {
+            return false;
+        }
+
+        const char* base = archivo.obtenerDatos();
+        if (CodificacionBinaria::leerEntero32(base + 4) != VERSION) {
+            return false;
+        }
+
+        int64_t tamanio, modificacion;
+        if (!ArchivoMapeado::obtenerFirma(rutaOrigen, tamanio, modificacion)) {
+            return false;
+        }
+        return CodificacionBinaria::leerEntero64(base + 20) == tamanio &&
+               CodificacionBinaria::leerEntero64(base + 28) == modificacion;
+    }
+
+    // Leer la cabecera y validar las columnas de un archivo ya proyectado
+    void abrir(const ArchivoMapeado& archivo) {
+        cerrar();
+
+        const char* base = archivo.obtenerDatos();
+        size_t tamanioArchivo = archivo.obtenerTamanio();
+
+        if (!esFormatoColumnar(archivo) || tamanioArchivo < static_cast<size_t>(TAMANIO_CABECERA)) {
+            throw std::runtime_error("El archivo no es una biblioteca columnar");
+        }
+
+        int version = CodificacionBinaria::leerEntero32(base + 4);
+        if (version != VERSION) {
+            throw std::runtime_error("Versión de biblioteca no soportada: " + std::to_string(version));
+        }
+
+        int canciones = CodificacionBinaria::leerEntero32(base + 8);
+        int generos = CodificacionBinaria::leerEntero32(base + 12);
+        int columnas = CodificacionBinaria::leerEntero32(base + 16);
+        if (canciones < 0 || generos < 0 || columnas != NUM_COLUMNAS) {
+            throw std::runtime_error("Cabecera de biblioteca inválida");
+        }
+
+        for (int c = 0; c < NUM_COLUMNAS; c++) {
+            const char* entrada = base + INICIO_COLUMNAS + 8 * c;
+            uint32_t desplazamiento = static_cast<uint32_t>(CodificacionBinaria::leerEntero32(entrada));
+            uint32_t tamanio = static_cast<uint32_t>(CodificacionBinaria::leerEntero32(entrada + 4));
+
+            if (static_cast<uint64_t>(desplazamiento) + tamanio > tamanioArchivo || tamanio > 0x7FFFFFFFU) {
+                throw std::runtime_error("Columna fuera de los límites del archivo");
+            }
+
+            secciones[c].datos = base + desplazamiento;
+            secciones[c].tamanio = static_cast<int>(tamanio);
+        }
+
+        numCanciones = canciones;
+        numGeneros = generos;
+
+        validarTabla(COLUMNA_TITULO, numCanciones, 1);
+        validarTabla(COLUMNA_ARTISTA, numCanciones, 1);
+        validarTabla(COLUMNA_ALBUM, numCanciones, 1);
+        validarTabla(COLUMNA_RUTA, numCanciones, 1);
+        validarTabla(COLUMNA_GENEROS, numCanciones, 4);
+        validarTabla(COLUMNA_NOMBRES_GENERO, numGeneros, 1);
+
+        const Columna columnasEnteras[] = {COLUMNA_ANIO, COLUMNA_DURACION, COLUMNA_REPRODUCCIONES};
+        for (Columna columna : columnasEnteras) {
+            if (secciones[columna].tamanio / 4 < numCanciones) {
+                throw std::runtime_error("Columna truncada");
+            }
+        }
+
+        int totalIds = leerEntero(COLUMNA_GENEROS, numCanciones);
+        const char* ids = secciones[COLUMNA_GENEROS].datos + 4 * (numCanciones + 1);
+        for (int i = 0; i < totalIds; i++) {
+            int id = CodificacionBinaria::leerEntero32(ids + 4 * i);
+            if (id < 0 || id >= numGeneros) {
+                throw std::runtime_error("Identificador de género inválido");
+            }
+        }
+    }
+
+    // Olvidar el archivo actual
+    void cerrar() {
+        for (int c = 0; c < NUM_COLUMNAS; c++) {
+            secciones[c].datos = nullptr;
+            secciones[c].tamanio = 0;
+        }
+        numCanciones = 0;
+        numGeneros = 0;
+    }
+
+    // Obtener número de canciones
+    int obtenerNumCanciones() const {
+        return numCanciones;
+    }
+
+    // Obtener número de géneros
+    int obtenerNumGeneros() const {
+        return numGeneros;
+    }
+
+    // Obtener el texto de un registro en una columna de texto
+    VistaCadena obtenerTexto(Columna columna, int registro) const {
+        int entradas = columna == COLUMNA_NOMBRES_GENERO ? numGeneros : numCanciones;
+        if (registro < 0 || registro >= entradas) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+
+        int inicio = leerEntero(columna, registro);
+        int fin = leerEntero(columna, registro + 1);
+        return VistaCadena(secciones[columna].datos + 4 * (entradas + 1) + inicio, fin - inicio);
+    }
+
+    // Obtener el valor de un registro en una columna de enteros
+    int obtenerEntero(Columna columna, int registro) const {
+        if (registro < 0 || registro >= numCanciones) {
+            throw std::out_of_range("Índice fuera de rango");
+        }
+        return leerEntero(columna, registro);
+    }
+
+    // Obtener el nombre de un género por su identificador
+    VistaCadena obtenerNombreGenero(int id) const {
+        return obtenerTexto(COLUMNA_NOMBRES_GENERO, id);
+    }
+
+    // Construir la canción de un registro como vistas sobre el archivo
+    // Los identificadores de género de la biblioteca deben coincidir con los del diccionario
+    Cancion obtenerCancion(int registro, const DiccionarioGeneros* diccionario) const {
+        Cancion cancion(obtenerTexto(COLUMNA_TITULO, registro),
+                        obtenerTexto(COLUMNA_ARTISTA, registro),
+                        obtenerTexto(COLUMNA_ALBUM, registro),
+                        leerEntero(COLUMNA_ANIO, registro),
+                        leerEntero(COLUMNA_DURACION, registro));
+        cancion.ruta = obtenerTexto(COLUMNA_RUTA, registro);
+        cancion.reproducciones = leerEntero(COLUMNA_REPRODUCCIONES, registro);
+
+        int inicio = leerEntero(COLUMNA_GENEROS, registro);
+        int fin = leerEntero(COLUMNA_GENEROS, registro + 1);
+        const char* ids = secciones[COLUMNA_GENEROS].datos + 4 * (numCanciones + 1 + inicio);
+        cancion.generos = VistaGeneros(ids, fin - inicio, diccionario);
+
+        return cancion;
+    }
+};
+
+/**
+ * @brief Conversión única de library.dat al formato columnar
+ */
+class ConversorBiblioteca {
+private:
+    // Columna de longitud variable en construcción
+    struct ColumnaVariable {
+        std::string desplazamientos;
+        std::string datos;
+        int tamanioElemento;
+
+        ColumnaVariable(int _tamanioElemento = 1) : tamanioElemento(_tamanioElemento) {
+            CodificacionBinaria::agregarEntero32(desplazamientos, 0);
+        }
+
+        // Cerrar el registro actual
+        void cerrarRegistro() {
+            CodificacionBinaria::agregarEntero32(desplazamientos, static_cast<int>(datos.length()) / tamanioElemento);
+        }
+
+        // Contenido final: tabla de desplazamientos seguida de los datos
+        std::string ensamblar() const {
+            return desplazamientos + datos;
+        }
+    };
+
+    static void agregarTexto(ColumnaVariable& columna, const VistaCadena& texto) {
+        columna.datos.append(texto.obtenerDatos(), texto.obtenerLongitud());
+        columna.cerrarRegistro();
+    }
+
+public:
+    // Ruta por defecto de la biblioteca convertida (misma ruta con extensión .lmpb)
+    static std::string rutaConvertida(const std::string& rutaOrigen) {
+        size_t separador = rutaOrigen.find_last_of("/\\");
+        size_t punto = rutaOrigen.find_last_of('.');
+
+        if (punto == std::string::npos || (separador != std::string::npos && punto < separador)) {
+            return rutaOrigen + ".lmpb";
+        }
+        return rutaOrigen.substr(0, punto) + ".lmpb";
+    }
+
+    // Convertir una biblioteca del formato de library.dat al formato columnar
+    static void convertir(const std::string& rutaOrigen, const std::string& rutaDestino) {
+        // La firma se toma antes de leer: si el origen cambia durante la conversión,
+        // la próxima carga la repetirá
+        int64_t tamanioOrigen, modificacionOrigen;
+        ArchivoMapeado origen;
+        if (!ArchivoMapeado::obtenerFirma(rutaOrigen, tamanioOrigen, modificacionOrigen) ||
+            !origen.abrir(rutaOrigen)) {
+            throw std::runtime_error("No se pudo abrir " + rutaOrigen);
+        }
+
+        LectorBibliotecaLegada lector(origen);
+        DiccionarioGeneros diccionario;
+
+        ColumnaVariable titulos, artistas, albumes, rutas, nombresGenero;
+        ColumnaVariable generos(4);
+        std::string anios, duraciones, reproducciones;
+
+        RegistroLegado registro;
+        int numCanciones = 0;
+        while (lector.siguiente(registro)) {
+            agregarTexto(titulos, registro.titulo);
+            agregarTexto(artistas, registro.artista);
+            agregarTexto(albumes, registro.album);
+            agregarTexto(rutas, registro.ruta);
+            CodificacionBinaria::agregarEntero32(anios, registro.anio);
+            CodificacionBinaria::agregarEntero32(duraciones, registro.duracion);
+            CodificacionBinaria::agregarEntero32(reproducciones, registro.reproducciones);
+
+            LectorBinario lectorGeneros(registro.bloqueGeneros.obtenerDatos(),
+                                        registro.bloqueGeneros.obtenerLongitud());
+            for (int j = 0; j < registro.numGeneros; j++) {
+                VistaCadena genero = lectorGeneros.leerCadena();
+                int id = diccionario.buscar(genero);
+                if (id == -1) {
+                    id = diccionario.agregar(genero);
+                    agregarTexto(nombresGenero, genero);
+                }
+                CodificacionBinaria::agregarEntero32(generos.datos, id);
+            }
+            generos.cerrarRegistro();
+
+            numCanciones++;
+        }
+
+        // Ensamblar las columnas en el orden de BibliotecaColumnar::Columna
+        std::string columnas[BibliotecaColumnar::NUM_COLUMNAS];
+        columnas[BibliotecaColumnar::COLUMNA_TITULO] = titulos.ensamblar();
+        columnas[BibliotecaColumnar::COLUMNA_ARTISTA] = artistas.ensamblar();
+        columnas[BibliotecaColumnar::COLUMNA_ALBUM] = albumes.ensamblar();
+        columnas[BibliotecaColumnar::COLUMNA_RUTA] = rutas.ensamblar();
+        columnas[BibliotecaColumnar::COLUMNA_ANIO] = anios;
+        columnas[BibliotecaColumnar::COLUMNA_DURACION] = duraciones;
+        columnas[BibliotecaColumnar::COLUMNA_REPRODUCCIONES] = reproducciones;
+        columnas[BibliotecaColumnar::COLUMNA_GENEROS] = generos.ensamblar();
+        columnas[BibliotecaColumnar::COLUMNA_NOMBRES_GENERO] = nombresGenero.ensamblar();
+
+        std::string cabecera("LMPB", 4);
+        CodificacionBinaria::agregarEntero32(cabecera, BibliotecaColumnar::VERSION);
+        CodificacionBinaria::agregarEntero32(cabecera, numCanciones);
+        CodificacionBinaria::agregarEntero32(cabecera, diccionario.obtenerTamanio());
+        CodificacionBinaria::agregarEntero32(cabecera, BibliotecaColumnar::NUM_COLUMNAS);
+        CodificacionBinaria::agregarEntero64(cabecera, tamanioOrigen);
+        CodificacionBinaria::agregarEntero64(cabecera, modificacionOrigen);
+
+        uint64_t desplazamiento = BibliotecaColumnar::TAMANIO_CABECERA;
+        for (int c = 0; c < BibliotecaColumnar::NUM_COLUMNAS; c++) {
+            desplazamiento = (desplazamiento + 3) & ~static_cast<uint64_t>(3);
+            if (desplazamiento + columnas[c].length() > 0xFFFFFFFFULL) {
+                throw std::runtime_error("La biblioteca supera el tamaño máximo del formato (4 GiB)");
+            }
+
+            CodificacionBinaria::agregarEntero32(cabecera, static_cast<int>(desplazamiento));
+            CodificacionBinaria::agregarEntero32(cabecera, static_cast<int>(columnas[c].length()));
+            desplazamiento += columnas[c].length();
+        }
+
+        // Escribir en un archivo temporal y reemplazar el destino al terminar
+        std::string rutaTemporal = rutaDestino + ".tmp";
+        {
+            std::ofstream salida(rutaTemporal.c_str(), std::ios::binary | std::ios::trunc);
+            if (!salida) {
+                throw std::runtime_error("No se pudo crear " + rutaTemporal);
+            }
+
+            salida.write(cabecera.data(), cabecera.length());
+            uint64_t escritos = cabecera.length();
+            for (int c = 0; c < BibliotecaColumnar::NUM_COLUMNAS; c++) {
+                while (escritos % 4 != 0) {
+                    salida.put('\0');
+                    escritos++;
+                }
+                salida.write(columnas[c].data(), columnas[c].length());
+                escritos += columnas[c].length();
+            }
+
+            if (!salida) {
+                std::remove(rutaTemporal.c_str());
+                throw std::runtime_error("Error al escribir " + rutaTemporal);
+            }
+        }
+
+        std::remove(rutaDestino.c_str());
+        if (std::rename(rutaTemporal.c_str(), rutaDestino.c_str()) != 0) {
+            std::remove(rutaTemporal.c_str());
+            throw std::runtime_error("No se pudo crear " + rutaDestino);
+        }
+    }
+};
+
+// ==================== REPRODUCTOR DE MÚSICA ====================
+
+/**
+ * @brief Clase principal del reproductor de música
+ */
+class ReproductorMusica {
+public:
+    // Campos por los que se puede ver la biblioteca ordenada
+    enum CampoOrden {
+        ORDEN_INSERCION,        // Orden de llegada (el de los identificadores)
+        ORDEN_TITULO,
+        ORDEN_ARTISTA,          // Artista, álbum y año
+        ORDEN_ALBUM,
+        ORDEN_ANIO,
+        ORDEN_DURACION,
+        NUM_ORDENES
+    };
+
+    // Campos de texto de cada canción en la columna de búsqueda (bit 1 << campo en las máscaras)
+    enum CampoTexto {
+        TEXTO_TITULO,
+        TEXTO_ARTISTA,
+        TEXTO_ALBUM,
+        NUM_CAMPOS_TEXTO
+    };
+
+private:
+    // Género de un artista y cuántas de sus canciones lo tienen
+    struct GeneroArtista {
+        int genero;
+        int canciones;
+
+        GeneroArtista(int _genero, int _canciones) : genero(_genero), canciones(_canciones) {}
+    };
+
+    ArchivoMapeado archivoBiblioteca;
+    BibliotecaColumnar biblioteca;
+    DiccionarioGeneros diccionarioGeneros;
+    AlmacenTexto almacenTexto;
+    Lista<Cancion> canciones;                       // Por identificador, incluidas las eliminadas
+    int numEliminadas;
+    Lista<ListaReproduccion> listasReproduccion;
+    SecuenciaPersistente<int> historial;            // Últimas canciones reproducidas, la más reciente al final
+    int limiteHistorial;
+    SecuenciaPersistente<int> colaReproduccion;
+    Grafo<VistaCadena> grafoAfinidad;
+    Lista<Lista<GeneroArtista>> generosDeArtista;   // Por id de vértice del artista
+    Lista<Lista<int>> artistasDeGenero;             // Por id de vértice del género
+    IndiceTexto indiceTitulos;
+    IndiceTexto indiceArtistas;
+    TriePrefijos indicePrefijos;
+    ColumnaTexto columnaTexto;                      // Claves de título, artista y álbum para recorridos completos
+    Lista<MapaBits> cancionesDeGenero;              // Por id del diccionario de géneros
+    TablaHash<VistaCadena, int> posicionArtista;    // Artista -> posición en cancionesDeArtista
+    Lista<Lista<int>> cancionesDeArtista;
+
+    // Canciones que recuerda el historial si no se indica otra capacidad
+    static const int CAPACIDAD_HISTORIAL = 100;
+
+    // Parámetros del recorrido de recomendaciones
+    static const int PROFUNDIDAD_RECOMENDACION = 3;
+    static const int ANCHO_HAZ_RECOMENDACION = 64;
+
+    // Canción recomendada: ordena por puntuación, luego por reproducciones
+    struct Recomendacion {
+        double puntuacion;
+        int reproducciones;
+        int cancion;
+
+        Recomendacion(double _puntuacion, int _reproducciones, int _cancion)
+            : puntuacion(_puntuacion), reproducciones(_reproducciones), cancion(_cancion) {}
+
+        bool operator>(const Recomendacion& otra) const {
+            if (puntuacion != otra.puntuacion) {
+                return puntuacion > otra.puntuacion;
+            }
+            if (reproducciones != otra.reproducciones) {
+                return reproducciones > otra.reproducciones;
+            }
+            return cancion < otra.cancion;
+        }
+    };
+
+    // Memoria de trabajo de las recomendaciones, reutilizada entre consultas
+    mutable Lista<Grafo<VistaCadena>::VerticePuntuado> afinesRecomendacion;
+    mutable ColaPrioridad<Recomendacion, std::greater<Recomendacion>> mejoresRecomendacion;
+
+    // Parámetros del PageRank personalizado
+    static const int MAX_ITERACIONES_PAGERANK = 50;
+    static const int VERTICES_POR_SEMILLA = 256;     // Vértices guardados por cada resultado
+    static const int MAX_SEMILLAS_EN_CACHE = 256;
+
+    // Caché de PageRank por conjunto de semillas; se vacía cuando cambia el grafo
+    mutable TablaHash<std::string, int> posicionPageRank;
+    mutable Lista<Lista<Grafo<VistaCadena>::VerticePuntuado>> resultadosPageRank;
+
+    // Permutaciones de la biblioteca por campo: se construyen la primera vez que se piden
+    // y después se mantienen al agregar o eliminar canciones. Las canciones nunca se mueven
+    // y una eliminada deja su hueco, así que sus identificadores (los que guardan listas,
+    // cola e historial) son estables. El orden de llegada es el de los identificadores y
+    // solo se guarda cuando hay huecos que saltar
+    Lista<int> ordenes[NUM_ORDENES];
+    bool ordenConstruido[NUM_ORDENES];
+    CampoOrden ordenActual;
+    bool ordenAscendente;
+
+    int cancionActual;
+    bool reproduciendo;
+
+    // Modo aleatorio: cada vuelta recorre una permutación de la biblioteca empezando en
+    // la posición 'inicioAleatorio', así que no se repite ninguna canción hasta agotarla
+    bool modoAleatorio;
+    uint64_t semillaAleatoria;
+    PermutacionAleatoria permutacionAleatoria;
+    int vueltaAleatoria;
+    int inicioAleatorio;
+    int pasoAleatorio;      // Canciones avanzadas en la vuelta actual
+
+    // Mezcla inteligente: cada canción pesa según sus reproducciones y las veces que se
+    // saltó, y cada artista según la suma de sus canciones y su afinidad con lo que sonó
+    // hace poco. Se elige primero el artista y luego la canción, así que la afinidad de
+    // un artista cambia un solo peso aunque tenga miles de canciones
+    static const int RECIENTES_MEZCLA = 8;      // Canciones que cuentan como recientes
+    static const int VECINOS_AFINES = 3;        // Artistas afines que también suben
+    static const int AFINIDAD_MAXIMA = 3;       // Cuánto puede multiplicarse el peso de un artista
+    bool mezclaInteligente;
+    TablaAlias tablaMezcla;                     // Por posición en cancionesDeArtista
+    Lista<TablaAlias> tablasArtista;            // Por artista: pesos de sus canciones
+    Lista<double> afinidadArtista;              // Por artista
+    Lista<int> afinesMezcla;                    // Por artista, VECINOS_AFINES huecos (-2: sin calcular)
+    Lista<int> artistaDeCancion;                // Por canción: posición de su artista
+    Lista<int> posicionEnArtista;               // Por canción: posición en las canciones de su artista
+    ColaDoble<int> recientesMezcla;             // La más antigua al frente
+
+    // Estado que deshacen y rehacen las acciones de reproducción. Copiarlo es O(1)
+    // porque la cola y el historial son persistentes y las copias comparten sus nodos
+    struct EstadoReproduccion {
+        SecuenciaPersistente<int> cola;
+        SecuenciaPersistente<int> historial;
+        int cancionActual;
+        int vueltaAleatoria;
+        int inicioAleatorio;
+        int pasoAleatorio;
+        int eliminadas;         // Canciones eliminadas al capturarlo; si hay más, puede nombrar alguna
+
+        EstadoReproduccion()
+            : cancionActual(-1), vueltaAleatoria(0), inicioAleatorio(0), pasoAleatorio(0), eliminadas(0) {}
+    };
+
+    // Pasos que se pueden deshacer; al llenarse se olvidan los más antiguos
+    static const int PASOS_DESHACER = 500;
+    PilaCircular<EstadoReproduccion> estadosAnteriores;
+    PilaCircular<EstadoReproduccion> estadosDeshechos;
+
+    // Proyectar la biblioteca columnar en memoria y cargar sus canciones
+    // Si la ruta apunta al formato de library.dat, se migra a un .lmpb vecino, que se
+    // regenera cuando el tamaño o la fecha de modificación del origen ya no coinciden.
+    // Si no se puede escribir el .lmpb, se carga library.dat directamente
+    bool cargarBiblioteca(const std::string& ruta) {
+        try {
+            if (!archivoBiblioteca.abrir(ruta)) {
+                std::cerr << "No se pudo abrir la biblioteca: " << ruta << std::endl;
+                return false;
+            }
+
+            if (!BibliotecaColumnar::esFormatoColumnar(archivoBiblioteca)) {
+                std::string rutaColumnar = ConversorBiblioteca::rutaConvertida(ruta);
+                archivoBiblioteca.cerrar();
+
+                if (!archivoBiblioteca.abrir(rutaColumnar) ||
+                    !BibliotecaColumnar::correspondeAOrigen(archivoBiblioteca, ruta)) {
+                    archivoBiblioteca.cerrar();
+                    try {
+                        ConversorBiblioteca::convertir(ruta, rutaColumnar);
+                    } catch (const std::exception& e) {
+                        // Directorio de solo lectura, disco lleno...: leer el formato original
+                        std::cerr << "No se pudo convertir la biblioteca: " << e.what() << std::endl;
+                        if (!archivoBiblioteca.abrir(ruta)) {
+                            std::cerr << "No se pudo abrir la biblioteca: " << ruta << std::endl;
+                            return false;
+                        }
+                        cargarBibliotecaLegada();
+                        return true;
+                    }
+
+                    if (!archivoBiblioteca.abrir(rutaColumnar)) {
+                        std::cerr << "No se pudo abrir la biblioteca: " << rutaColumnar << std::endl;
+                        return false;
+                    }
+                }
+            }
+
+            biblioteca.abrir(archivoBiblioteca);
+
+            // Los identificadores del diccionario coinciden con los del archivo
+            for (int id = 0; id < biblioteca.obtenerNumGeneros(); id++) {
+                diccionarioGeneros.agregar(biblioteca.obtenerNombreGenero(id));
+            }
+
+            for (int registro = 0; registro < biblioteca.obtenerNumCanciones(); registro++) {
+                Cancion cancion = biblioteca.obtenerCancion(registro, &diccionarioGeneros);
+                calcularClaves(cancion);
+                canciones.agregar(cancion);
+                indexarCancion(registro);
+            }
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error al cargar biblioteca: " << e.what() << std::endl;
+            canciones.vaciar();
+            indiceTitulos.vaciar();
+            indiceArtistas.vaciar();
+            indicePrefijos.vaciar();
+            columnaTexto.vaciar();
+            cancionesDeGenero.vaciar();
+            posicionArtista.vaciar();
+            cancionesDeArtista.vaciar();
+            for (int campo = 0; campo < NUM_ORDENES; campo++) {
+                ordenes[campo].vaciar();
+                ordenConstruido[campo] = false;
+            }
+            diccionarioGeneros.vaciar();
+            biblioteca.cerrar();
+            archivoBiblioteca.cerrar();
+            return false;
+        }
+    }
+
+    // Cargar las canciones recorriendo el library.dat proyectado, sin formato columnar
+    // Los textos apuntan al archivo, que sigue abierto mientras exista el reproductor
+    void cargarBibliotecaLegada() {
+        LectorBibliotecaLegada lector(archivoBiblioteca);
+        RegistroLegado registro;
+
+        while (lector.siguiente(registro)) {
+            Cancion cancion(registro.titulo, registro.artista, registro.album, registro.anio, registro.duracion);
+            cancion.ruta = registro.ruta;
+            cancion.reproducciones = registro.reproducciones;
+
+            if (registro.numGeneros > 0) {
+                char* ids = almacenTexto.reservar(4 * registro.numGeneros);
+                LectorBinario lectorGeneros(registro.bloqueGeneros.obtenerDatos(),
+                                            registro.bloqueGeneros.obtenerLongitud());
+                for (int j = 0; j < registro.numGeneros; j++) {
+                    VistaCadena genero = lectorGeneros.leerCadena();
+                    int id = diccionarioGeneros.buscar(genero);
+                    if (id == -1) {
+                        id = diccionarioGeneros.agregar(genero);
+                    }
+                    CodificacionBinaria::escribirEntero32(ids + 4 * j, id);
+                }
+                cancion.generos = VistaGeneros(ids, registro.numGeneros, &diccionarioGeneros);
+            }
+
+            calcularClaves(cancion);
+            canciones.agregar(cancion);
+            indexarCancion(canciones.obtenerTamanio() - 1);
+        }
+    }
+
+    // Método para cargar listas de reproducción ficticias a partir de los títulos de la biblioteca
+    void cargarListasFicticias() {
+        try {
+            const char* clasicos[] = {"Bohemian Rhapsody", "Stairway to Heaven", "Hotel California",
+                                      "Sweet Child O' Mine", "Smells Like Teen Spirit"};
+            const char* exitosPop[] = {"Imagine", "Billie Jean", "I Want to Hold Your Hand"};
+
+            ListaReproduccion lista1("Clásicos del Rock", "Las mejores canciones de rock de todos los tiempos");
+            for (const char* titulo : clasicos) {
+                int indice = buscarIndicePorTitulo(titulo);
+                if (indice != -1) {
+                    lista1.agregarCancion(indice);
                 }
             }
+
+            ListaReproduccion lista2("Pop Hits", "Éxitos del pop a través de las décadas");
+            for (const char* titulo : exitosPop) {
+                int indice = buscarIndicePorTitulo(titulo);
+                if (indice != -1) {
+                    lista2.agregarCancion(indice);
+                }
+            }
+
+            // Agregar listas a la biblioteca
+            listasReproduccion.agregar(std::move(lista1));
+            listasReproduccion.agregar(std::move(lista2));
+        } catch (const std::exception& e) {
+            std::cerr << "Error al cargar listas ficticias: " << e.what() << std::endl;
+        }
+    }
+
+    // Calcular las claves de colación de una canción
+    void calcularClaves(Cancion& cancion) {
+        cancion.claveTitulo = Colacion::normalizar(cancion.titulo, almacenTexto);
+        cancion.claveArtista = Colacion::normalizar(cancion.artista, almacenTexto);
+        cancion.claveAlbum = Colacion::normalizar(cancion.album, almacenTexto);
+    }
+
+    // Agregar una canción a los índices de búsqueda
+    void indexarCancion(int indice) {
+        const Cancion& cancion = canciones.obtener(indice);
+        indiceTitulos.agregar(indice, cancion.claveTitulo);
+        indiceArtistas.agregar(indice, cancion.claveArtista);
+        indicePrefijos.agregar(indice, cancion.claveTitulo, cancion.reproducciones);
+        indicePrefijos.agregar(indice, cancion.claveArtista, cancion.reproducciones);
+        indicePrefijos.agregar(indice, cancion.claveAlbum, cancion.reproducciones);
+        columnaTexto.agregarCampo(cancion.claveTitulo);
+        columnaTexto.agregarCampo(cancion.claveArtista);
+        columnaTexto.agregarCampo(cancion.claveAlbum);
+
+        for (int i = 0; i < cancion.generos.obtenerTamanio(); i++) {
+            int genero = cancion.generos.obtenerId(i);
+            while (cancionesDeGenero.obtenerTamanio() <= genero) {
+                cancionesDeGenero.emplazar();
+            }
+            cancionesDeGenero.obtener(genero).agregar(indice);
         }
 
-        delete[] visitados;
-        return resultado;
+        const int* posicion = posicionArtista.buscar(cancion.artista);
+        if (posicion) {
+            cancionesDeArtista.obtener(*posicion).agregar(indice);
+        } else {
+            posicionArtista.insertar(cancion.artista, cancionesDeArtista.obtenerTamanio());
+            cancionesDeArtista.emplazar().agregar(indice);
+        }
     }
 
-    // Obtener vértices adyacentes (DFS)
-    Lista<T> obtenerVecinosDFS(const T& origen) const {
-        Lista<T> resultado;
-        int indiceOrigen = buscarVertice(origen);
+    // Quitar una canción de los índices de búsqueda al eliminarla de la biblioteca
+    // Solo se tocan sus trigramas, sus claves, sus géneros y su artista. La columna de
+    // texto conserva sus campos: los recorridos descartan las eliminadas
+    // Un artista que se queda sin canciones conserva su posición con la lista vacía
+    void desindexarCancion(int indice) {
+        const Cancion& cancion = canciones.obtener(indice);
+        indiceTitulos.eliminarDocumento(indice, cancion.claveTitulo);
+        indiceArtistas.eliminarDocumento(indice, cancion.claveArtista);
+        indicePrefijos.quitar(indice);
+
+        for (int i = 0; i < cancion.generos.obtenerTamanio(); i++) {
+            cancionesDeGenero.obtener(cancion.generos.obtenerId(i)).eliminar(indice);
+        }
 
-        if (indiceOrigen == -1) {
-            return resultado;
+        const int* posicion = posicionArtista.buscar(cancion.artista);
+        if (posicion) {
+            Busqueda::eliminarOrdenado(cancionesDeArtista.obtener(*posicion), indice);
+        }
+    }
+
+    // Quitar de una lista de identificadores las canciones eliminadas, conservando el orden
+    void descartarEliminadas(Lista<int>& indices) const {
+        if (numEliminadas == 0) {
+            return;
+        }
+
+        int escritura = 0;
+        for (int i = 0; i < indices.obtenerTamanio(); i++) {
+            int cancion = indices.obtener(i);
+            if (!canciones.obtener(cancion).eliminada) {
+                indices.obtener(escritura++) = cancion;
+            }
+        }
+        while (indices.obtenerTamanio() > escritura) {
+            indices.eliminar(indices.obtenerTamanio() - 1);
+        }
+    }
+
+    // Buscar las canciones cuya clave contiene el texto (sin distinguir mayúsculas ni acentos),
+    // usando el índice del campo para descartar las que no pueden coincidir
+    Lista<int> buscarEnCampo(const IndiceTexto& indice, VistaCadena Cancion::*clave, CampoTexto campo,
+                             const std::string& texto) const {
+        Lista<int> resultados;
+        std::string consulta = Colacion::normalizar(texto);
+        Lista<int> candidatos;
+
+        if (indice.obtenerCandidatos(consulta, candidatos)) {
+            for (int i : candidatos) {
+                if (Busqueda::contiene(canciones.obtener(i).*clave, consulta)) {
+                    resultados.agregar(i);
+                }
+            }
+        } else {
+            // Consulta demasiado corta para el índice: recorrer la columna de texto
+            columnaTexto.buscar(consulta, 1u << campo, resultados);
+            descartarEliminadas(resultados);
+        }
+
+        return resultados;
+    }
+
+    // Buscar las canciones cuya clave contiene el texto con hasta 'tolerancia' errores
+    // (inserciones, borrados o sustituciones), ordenadas de menor a mayor distancia
+    Lista<int> buscarAproximadoEnCampo(const IndiceTexto& indice, CampoTexto campo,
+                                       const std::string& texto, int tolerancia) const {
+        std::string consulta = Colacion::normalizar(texto);
+        PatronDifuso patron(consulta);
+
+        Lista<Lista<int>> porDistancia;
+        for (int distancia = 0; distancia <= tolerancia; distancia++) {
+            porDistancia.emplazar();
+        }
+
+        auto verificar = [&](int cancion) {
+            int distancia = patron.distancia(columnaTexto.obtenerCampo(cancion, campo), tolerancia);
+            if (distancia <= tolerancia) {
+                porDistancia.obtener(distancia).agregar(cancion);
+            }
+        };
+
+        Lista<int> candidatos;
+        if (indice.obtenerCandidatosAproximados(consulta, tolerancia, candidatos)) {
+            for (int i : candidatos) {
+                verificar(i);
+            }
+        } else {
+            // El filtro no descarta nada con esta tolerancia: recorrer la columna completa
+            for (int i = 0; i < columnaTexto.obtenerNumDocumentos(); i++) {
+                if (!canciones.obtener(i).eliminada) {
+                    verificar(i);
+                }
+            }
+        }
+
+        Lista<int> resultados;
+        for (const Lista<int>& grupo : porDistancia) {
+            for (int cancion : grupo) {
+                resultados.agregar(cancion);
+            }
+        }
+        return resultados;
+    }
+
+    // Buscar el índice de la canción con un título exacto
+    int buscarIndicePorTitulo(const VistaCadena& titulo) const {
+        for (int i = 0; i < canciones.obtenerTamanio(); i++) {
+            if (!canciones.obtener(i).eliminada && canciones.obtener(i).titulo == titulo) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Traducir los géneros de una canción al diccionario del reproductor y guardar
+    // sus identificadores en el almacén de texto
+    VistaGeneros guardarGeneros(const VistaGeneros& generos) {
+        if (generos.estaVacia()) {
+            return VistaGeneros();
+        }
+
+        char* ids = almacenTexto.reservar(4 * generos.obtenerTamanio());
+        for (int i = 0; i < generos.obtenerTamanio(); i++) {
+            VistaCadena nombre = generos.obtener(i);
+            int id = diccionarioGeneros.buscar(nombre);
+            if (id == -1) {
+                id = diccionarioGeneros.agregar(almacenTexto.guardar(nombre));
+            }
+            CodificacionBinaria::escribirEntero32(ids + 4 * i, id);
+        }
+
+        return VistaGeneros(ids, generos.obtenerTamanio(), &diccionarioGeneros);
+    }
+
+    // Palabras por máscara de géneros a partir de las cuales se cuentan los géneros
+    // compartidos en lugar de hacer el AND de las máscaras
+    static const int PALABRAS_MAXIMAS_MASCARA = 4;
+
+    // Construir grafo de afinidad para recomendaciones
+    // Cada artista se une a sus géneros, y dos artistas se unen con un peso igual al
+    // número de géneros que comparten. Los pares salen de agrupar a los artistas por
+    // género, así que el coste es proporcional a las canciones más las aristas generadas
+    void construirGrafoAfinidad() {
+        try {
+            grafoAfinidad.vaciar();
+            generosDeArtista.vaciar();
+            artistasDeGenero.vaciar();
+            vaciarCachePageRank();
+
+            // Géneros distintos de cada artista y artistas de cada género, por id de vértice
+            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
+                const Cancion& cancion = canciones.obtener(i);
+                if (cancion.eliminada) {
+                    continue;
+                }
+                int artista = grafoAfinidad.agregarVerticeSiNoExiste(cancion.artista);
+
+                for (int j = 0; j < cancion.generos.obtenerTamanio(); j++) {
+                    int genero = grafoAfinidad.agregarVerticeSiNoExiste(cancion.generos.obtener(j));
+                    asegurarEstadoAfinidad();
+
+                    GeneroArtista* existente = buscarGeneroArtista(artista, genero);
+                    if (existente) {
+                        existente->canciones++;
+                    } else {
+                        generosDeArtista.obtener(artista).emplazar(genero, 1);
+                        artistasDeGenero.obtener(genero).agregar(artista);
+                        grafoAfinidad.agregarAristaSinVerificar(artista, genero);
+                        grafoAfinidad.agregarAristaSinVerificar(genero, artista);
+                    }
+                }
+            }
+
+            // Géneros de cada artista como máscara de bits: los géneros que comparten dos
+            // artistas son los bits a 1 del AND de sus máscaras. Solo los artistas con
+            // géneros tienen fila. Si hay tantos géneros que el AND recorrería demasiadas
+            // palabras por pareja, los géneros compartidos se cuentan al encontrarlos
+            int numVertices = generosDeArtista.obtenerTamanio();
+            Lista<int> bitDeGenero;   // Por id de vértice del género
+            Lista<int> filaDeArtista; // Por id de vértice del artista
+            int numGeneros = 0;
+            int numFilas = 0;
+            for (int v = 0; v < numVertices; v++) {
+                bitDeGenero.agregar(artistasDeGenero.obtener(v).estaVacia() ? -1 : numGeneros++);
+                filaDeArtista.agregar(generosDeArtista.obtener(v).estaVacia() ? -1 : numFilas++);
+            }
+
+            int palabras = (numGeneros + 63) / 64;
+            bool usarMascaras = palabras <= PALABRAS_MAXIMAS_MASCARA &&
+                                static_cast<int64_t>(numFilas) * palabras <= std::numeric_limits<int>::max();
+
+            Lista<uint64_t> mascaras;
+            if (usarMascaras) {
+                mascaras.reservar(numFilas * palabras);
+                for (int i = 0; i < numFilas * palabras; i++) {
+                    mascaras.agregar(0);
+                }
+                for (int artista = 0; artista < numVertices; artista++) {
+                    if (filaDeArtista.obtener(artista) == -1) {
+                        continue;
+                    }
+                    uint64_t* propia = mascaras.begin() + filaDeArtista.obtener(artista) * palabras;
+                    for (const GeneroArtista& entrada : generosDeArtista.obtener(artista)) {
+                        int bit = bitDeGenero.obtener(entrada.genero);
+                        propia[bit / 64] |= 1ull << (bit % 64);
+                    }
+                }
+            }
+
+            // Conectar artistas que comparten géneros, con el número de géneros en común como peso
+            Lista<int> ultimoOrigen;
+            Lista<int> generosCompartidos;
+            for (int v = 0; v < numVertices; v++) {
+                ultimoOrigen.agregar(-1);
+                generosCompartidos.agregar(0);
+            }
+
+            Lista<int> afines;
+            for (int artista = 0; artista < numVertices; artista++) {
+                for (const GeneroArtista& entrada : generosDeArtista.obtener(artista)) {
+                    for (int otro : artistasDeGenero.obtener(entrada.genero)) {
+                        if (otro == artista) {
+                            continue;
+                        }
+                        if (ultimoOrigen.obtener(otro) == artista) {
+                            if (!usarMascaras) {
+                                generosCompartidos.obtener(otro)++;
+                            }
+                            continue;
+                        }
+                        ultimoOrigen.obtener(otro) = artista;
+                        afines.agregar(otro);
+
+                        int compartidos = 1;
+                        if (usarMascaras) {
+                            const uint64_t* propia = mascaras.begin() + filaDeArtista.obtener(artista) * palabras;
+                            const uint64_t* ajena = mascaras.begin() + filaDeArtista.obtener(otro) * palabras;
+                            compartidos = 0;
+                            for (int p = 0; p < palabras; p++) {
+                                compartidos += MapaBits::contarBits(propia[p] & ajena[p]);
+                            }
+                        }
+                        generosCompartidos.obtener(otro) = compartidos;
+                    }
+                }
+
+                for (int otro : afines) {
+                    grafoAfinidad.agregarAristaSinVerificar(artista, otro, generosCompartidos.obtener(otro));
+                }
+                afines.vaciar();
+            }
+
+            // El grafo ya no cambia: compactarlo para los recorridos
+            grafoAfinidad.congelar();
+        } catch (const std::exception& e) {
+            std::cerr << "Error al construir grafo de afinidad: " << e.what() << std::endl;
+        }
+    }
+
+    // Ajustar el estado de afinidad al número actual de vértices
+    void asegurarEstadoAfinidad() {
+        while (generosDeArtista.obtenerTamanio() < grafoAfinidad.obtenerNumVertices()) {
+            generosDeArtista.emplazar();
+            artistasDeGenero.emplazar();
+        }
+    }
+
+    // Buscar un género entre los de un artista
+    GeneroArtista* buscarGeneroArtista(int artista, int genero) {
+        for (GeneroArtista& entrada : generosDeArtista.obtener(artista)) {
+            if (entrada.genero == genero) {
+                return &entrada;
+            }
+        }
+        return nullptr;
+    }
+
+    // Actualizar el grafo de afinidad con una canción que entra (+1) o sale (-1) de la biblioteca
+    // Solo se tocan el artista de la canción, sus géneros y los artistas de esos géneros
+    void actualizarAfinidad(const Cancion& cancion, int delta) {
+        vaciarCachePageRank();
+
+        int artista = delta > 0 ? grafoAfinidad.agregarVerticeSiNoExiste(cancion.artista)
+                                : grafoAfinidad.buscarVertice(cancion.artista);
+        if (artista == -1) {
+            return;
+        }
+
+        for (int j = 0; j < cancion.generos.obtenerTamanio(); j++) {
+            VistaCadena nombre = cancion.generos.obtener(j);
+            int genero = delta > 0 ? grafoAfinidad.agregarVerticeSiNoExiste(nombre)
+                                   : grafoAfinidad.buscarVertice(nombre);
+            if (genero == -1) {
+                continue;
+            }
+            asegurarEstadoAfinidad();
+
+            GeneroArtista* existente = buscarGeneroArtista(artista, genero);
+            if (delta > 0) {
+                if (existente) {
+                    existente->canciones++;
+                    continue;
+                }
+                generosDeArtista.obtener(artista).emplazar(genero, 1);
+            } else {
+                if (!existente || --existente->canciones > 0) {
+                    continue;
+                }
+                Lista<GeneroArtista>& generos = generosDeArtista.obtener(artista);
+                generos.eliminar(static_cast<int>(existente - generos.begin()));
+            }
+
+            // El artista entra o sale del género: actualizar las aristas con el género
+            // y el peso de las aristas con el resto de artistas del género
+            Lista<int>& artistas = artistasDeGenero.obtener(genero);
+            if (delta > 0) {
+                grafoAfinidad.agregarAristaPorId(artista, genero);
+                grafoAfinidad.agregarAristaPorId(genero, artista);
+            } else {
+                artistas.eliminar(artistas.buscar(artista));
+                grafoAfinidad.eliminarAristaPorId(artista, genero);
+                grafoAfinidad.eliminarAristaPorId(genero, artista);
+            }
+
+            for (int otro : artistas) {
+                if (otro != artista) {
+                    grafoAfinidad.ajustarPesoArista(artista, otro, delta);
+                    grafoAfinidad.ajustarPesoArista(otro, artista, delta);
+                }
+            }
+
+            if (delta > 0) {
+                artistas.agregar(artista);
+            }
+        }
+    }
+
+    // Descartar los resultados de PageRank guardados
+    void vaciarCachePageRank() const {
+        posicionPageRank.vaciar();
+        resultadosPageRank.vaciar();
+    }
+
+    // Obtener (calculándolo la primera vez) el PageRank sembrado en el artista y los géneros
+    // de una canción, ordenado de mayor a menor puntuación
+    const Lista<Grafo<VistaCadena>::VerticePuntuado>& obtenerPageRank(const Cancion& cancion) const {
+        typedef Grafo<VistaCadena>::VerticePuntuado VerticePuntuado;
+
+        // Semillas: la mitad de la masa en el artista y la otra mitad repartida entre los géneros
+        Lista<VerticePuntuado> semillas;
+        int artista = grafoAfinidad.buscarVertice(cancion.artista);
+        int numGeneros = cancion.generos.obtenerTamanio();
+        double masaArtista = numGeneros > 0 ? 0.5 : 1.0;
+        std::string clave;
+
+        if (artista != -1) {
+            semillas.emplazar(artista, masaArtista);
+            clave += std::to_string(artista);
+        }
+        for (int i = 0; i < numGeneros; i++) {
+            int genero = grafoAfinidad.buscarVertice(cancion.generos.obtener(i));
+            if (genero != -1) {
+                semillas.emplazar(genero, (1.0 - masaArtista) / numGeneros);
+                clave += "," + std::to_string(genero);
+            }
+        }
+
+        const int* posicion = posicionPageRank.buscar(clave);
+        if (posicion) {
+            return resultadosPageRank.obtener(*posicion);
+        }
+
+        if (resultadosPageRank.obtenerTamanio() >= MAX_SEMILLAS_EN_CACHE) {
+            vaciarCachePageRank();
         }
 
-        // Arreglo para marcar vértices visitados
-        bool* visitados = new bool[vertices.obtenerTamanio()];
-        for (int i = 0; i < vertices.obtenerTamanio(); i++) {
-            visitados[i] = false;
+        grafoAfinidad.calcularPageRankPersonalizado(semillas, 0.15, 1e-6, MAX_ITERACIONES_PAGERANK,
+                                                    afinesRecomendacion);
+
+        // Guardar solo los vértices más puntuados, de mayor a menor
+        ColaPrioridad<VerticePuntuado, std::greater<VerticePuntuado>> mejores;
+        for (const VerticePuntuado& puntuado : afinesRecomendacion) {
+            mejores.encolarAcotado(puntuado, VERTICES_POR_SEMILLA);
         }
 
-        // Llamada al método auxiliar recursivo
-        dfsRecursivo(indiceOrigen, resultado, visitados, indiceOrigen);
+        Lista<VerticePuntuado>& resultado = resultadosPageRank.emplazar();
+        resultado.reservar(mejores.obtenerTamanio());
+        while (!mejores.estaVacia()) {
+            resultado.agregar(mejores.frente());
+            mejores.desencolar();
+        }
+        for (int i = 0, j = resultado.obtenerTamanio() - 1; i < j; i++, j--) {
+            std::swap(resultado.obtener(i), resultado.obtener(j));
+        }
 
-        delete[] visitados;
+        posicionPageRank.insertar(clave, resultadosPageRank.obtenerTamanio() - 1);
         return resultado;
     }
 
-    // Vaciar el grafo
-    void vaciar() {
-        vertices.vaciar();
-        adyacencia.vaciar();
+    // Elegir las mejores canciones de los artistas puntuados, sin la canción de partida
+    // ni las del artista excluido
+    Lista<int> seleccionarRecomendaciones(const Lista<Grafo<VistaCadena>::VerticePuntuado>& afines,
+                                          int indiceCancion, int artistaExcluido, int cantidad) const {
+        // Las k mejores canciones, con la peor en el frente
+        ColaPrioridad<Recomendacion, std::greater<Recomendacion>>& mejores = mejoresRecomendacion;
+        mejores.vaciar();
+
+        for (const Grafo<VistaCadena>::VerticePuntuado& afin : afines) {
+            if (afin.vertice == artistaExcluido) {
+                continue;
+            }
+
+            // Con el montículo lleno, un artista peor puntuado que la peor canción no aporta nada
+            if (mejores.obtenerTamanio() == cantidad && afin.puntuacion < mejores.frente().puntuacion) {
+                continue;
+            }
+
+            // Los vértices de género no tienen canciones propias
+            const int* posicion = posicionArtista.buscar(grafoAfinidad.obtenerVertice(afin.vertice));
+            if (!posicion) {
+                continue;
+            }
+
+            for (int candidata : cancionesDeArtista.obtener(*posicion)) {
+                if (candidata != indiceCancion) {
+                    mejores.encolarAcotado(Recomendacion(afin.puntuacion,
+                                                         canciones.obtener(candidata).reproducciones,
+                                                         candidata), cantidad);
+                }
+            }
+        }
+
+        Lista<int> recomendaciones;
+        recomendaciones.reservar(mejores.obtenerTamanio());
+        while (!mejores.estaVacia()) {
+            recomendaciones.agregar(mejores.frente().cancion);
+            mejores.desencolar();
+        }
+
+        // El montículo entrega de peor a mejor
+        for (int i = 0, j = recomendaciones.obtenerTamanio() - 1; i < j; i++, j--) {
+            std::swap(recomendaciones.obtener(i), recomendaciones.obtener(j));
+        }
+        return recomendaciones;
     }
 
-    // Obtener número de vértices
-    int obtenerNumVertices() const {
-        return vertices.obtenerTamanio();
+    // Llamar al visitante con el criterio de ordenamiento de un campo
+    template <typename Visitante>
+    static int conCriterio(CampoOrden campo, Visitante visitante) {
+        switch (campo) {
+            case ORDEN_TITULO:
+                return visitante(CompararTitulo());
+            case ORDEN_ARTISTA:
+                return visitante(OrdenLexicografico<CompararArtista, CompararAlbum, CompararAnio>());
+            case ORDEN_ALBUM:
+                return visitante(CompararAlbum());
+            case ORDEN_ANIO:
+                return visitante(CompararAnio());
+            case ORDEN_DURACION:
+                return visitante(CompararDuracion());
+            default:
+                return -1;
+        }
     }
 
-private:
-    // Método auxiliar recursivo para DFS
-    void dfsRecursivo(int actual, Lista<T>& resultado, bool* visitados, int origen) const {
-        visitados[actual] = true;
+    // Construir la permutación de un campo si aún no existe, sin las canciones eliminadas
+    void construirOrden(CampoOrden campo) {
+        if (ordenConstruido[campo]) {
+            return;
+        }
+
+        if (campo == ORDEN_INSERCION) {
+            // Sin huecos, la posición de llegada es el propio identificador
+            if (numEliminadas == 0) {
+                return;
+            }
+            ordenes[campo].vaciar();
+            ordenes[campo].reservar(obtenerNumCanciones());
+            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
+                if (!canciones.obtener(i).eliminada) {
+                    ordenes[campo].agregar(i);
+                }
+            }
+        } else {
+            conCriterio(campo, [this, campo](auto criterio) {
+                ordenes[campo] = Ordenamiento<Cancion>::obtenerPermutacion(canciones, criterio);
+                return 0;
+            });
+            descartarEliminadas(ordenes[campo]);
+        }
+        ordenConstruido[campo] = true;
+    }
+
+    // Primera posición del orden cuya canción no va antes que la dada con el identificador
+    // indicado: entre canciones iguales el orden es el de los identificadores, así que el
+    // identificador es la última clave de la búsqueda (-1 para ir antes de todas las iguales)
+    int buscarEnOrden(CampoOrden campo, const Cancion& cancion, int indice) const {
+        const Lista<int>& orden = ordenes[campo];
+        if (campo == ORDEN_INSERCION) {
+            return Busqueda::cotaInferior(orden, indice);
+        }
+
+        const Lista<Cancion>& lista = canciones;
+        return conCriterio(campo, [&orden, &lista, &cancion, indice](auto criterio) {
+            int inicio = 0;
+            int fin = orden.obtenerTamanio();
+            while (inicio < fin) {
+                int medio = inicio + (fin - inicio) / 2;
+                int actual = orden.obtener(medio);
+                int comparacion = decltype(criterio)::comparar(lista.obtener(actual), cancion);
+                if (comparacion < 0 || (comparacion == 0 && actual < indice)) {
+                    inicio = medio + 1;
+                } else {
+                    fin = medio;
+                }
+            }
+            return inicio;
+        });
+    }
+
+    // Posición de una canción en el orden ascendente de un campo (-1 si no está)
+    int posicionEnOrden(CampoOrden campo, int indice) const {
+        if (campo == ORDEN_INSERCION && !ordenConstruido[campo]) {
+            return indice;
+        }
+
+        const Lista<int>& orden = ordenes[campo];
+        int posicion = buscarEnOrden(campo, canciones.obtener(indice), indice);
+        return posicion < orden.obtenerTamanio() && orden.obtener(posicion) == indice ? posicion : -1;
+    }
+
+    // Agregar la última canción de la biblioteca a las permutaciones construidas
+    void agregarAOrdenes() {
+        int indice = canciones.obtenerTamanio() - 1;
+        if (ordenConstruido[ORDEN_INSERCION]) {
+            ordenes[ORDEN_INSERCION].agregar(indice);
+        }
+        for (int campo = ORDEN_INSERCION + 1; campo < NUM_ORDENES; campo++) {
+            if (ordenConstruido[campo]) {
+                CampoOrden orden = static_cast<CampoOrden>(campo);
+                ordenes[campo].insertar(buscarEnOrden(orden, canciones.obtener(indice), indice), indice);
+            }
+        }
+    }
+
+    // Filtro de una consulta con su estimación de resultados
+    struct FiltroPlanificado {
+        const ConsultaBiblioteca::Filtro* filtro;
+        MapaBits canciones;     // Filtros de género: canciones de los géneros que coinciden
+        int estimacion;         // Cota del número de canciones que pasan el filtro
+        bool resuelto;          // Ya aplicado de forma exacta: no hace falta verificarlo
+
+        FiltroPlanificado() : filtro(nullptr), estimacion(0), resuelto(false) {}
+    };
+
+    // Índice de trigramas de un campo (nullptr si el campo no tiene)
+    const IndiceTexto* indiceDeCampo(ConsultaBiblioteca::Campo campo) const {
+        if (campo == ConsultaBiblioteca::CAMPO_TITULO) {
+            return &indiceTitulos;
+        }
+        if (campo == ConsultaBiblioteca::CAMPO_ARTISTA) {
+            return &indiceArtistas;
+        }
+        return nullptr;
+    }
+
+    // Posiciones [inicio, fin) del orden de un campo numérico cuyos valores están en [minimo, maximo]
+    void rangoEnOrden(CampoOrden campo, int minimo, int maximo, int& inicio, int& fin) {
+        construirOrden(campo);
+
+        Cancion limite;
+        limite.anio = limite.duracion = minimo;
+        inicio = buscarEnOrden(campo, limite, -1);
+        limite.anio = limite.duracion = maximo;
+        fin = std::max(inicio, buscarEnOrden(campo, limite, std::numeric_limits<int>::max()));
+    }
+
+    // Preparar un filtro y estimar cuántas canciones lo pasan
+    void planificarFiltro(const ConsultaBiblioteca::Filtro& filtro, FiltroPlanificado& plan) {
+        plan.filtro = &filtro;
+        plan.estimacion = canciones.obtenerTamanio();
+
+        switch (filtro.campo) {
+            case ConsultaBiblioteca::CAMPO_TITULO:
+            case ConsultaBiblioteca::CAMPO_ARTISTA: {
+                int estimacion = indiceDeCampo(filtro.campo)->estimarCandidatos(filtro.texto);
+                if (estimacion >= 0) {
+                    plan.estimacion = estimacion;
+                }
+                break;
+            }
+            case ConsultaBiblioteca::CAMPO_GENERO:
+                for (int genero = 0; genero < cancionesDeGenero.obtenerTamanio(); genero++) {
+                    VistaCadena nombre = diccionarioGeneros.obtenerNombre(genero);
+                    if (Busqueda::contiene(Colacion::normalizar(nombre), filtro.texto)) {
+                        plan.canciones = MapaBits::unir(plan.canciones, cancionesDeGenero.obtener(genero));
+                    }
+                }
+                plan.estimacion = plan.canciones.cardinalidad();
+                break;
+            case ConsultaBiblioteca::CAMPO_ANIO:
+            case ConsultaBiblioteca::CAMPO_DURACION: {
+                int inicio;
+                int fin;
+                rangoEnOrden(filtro.campo == ConsultaBiblioteca::CAMPO_ANIO ? ORDEN_ANIO : ORDEN_DURACION,
+                             filtro.minimo, filtro.maximo, inicio, fin);
+                plan.estimacion = fin - inicio;
+                break;
+            }
+            default:
+                break;
+        }
+
+        // De un filtro negado solo se sabe cuántas canciones descarta como mucho
+        if (filtro.negado) {
+            plan.estimacion = canciones.obtenerTamanio();
+        }
+    }
+
+    // Obtener en orden creciente las canciones que pasan un filtro
+    // Marca el filtro como resuelto si la lista es exacta y no solo un conjunto de candidatos
+    void materializarFiltro(FiltroPlanificado& plan, Lista<int>& resultado) {
+        const ConsultaBiblioteca::Filtro& filtro = *plan.filtro;
+        resultado.vaciar();
+        plan.resuelto = true;
+
+        if (filtro.negado) {
+            // Todas las canciones; el filtro se verifica después
+            resultado.reservar(obtenerNumCanciones());
+            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
+                if (!canciones.obtener(i).eliminada) {
+                    resultado.agregar(i);
+                }
+            }
+            plan.resuelto = false;
+            return;
+        }
+
+        switch (filtro.campo) {
+            case ConsultaBiblioteca::CAMPO_TITULO:
+            case ConsultaBiblioteca::CAMPO_ARTISTA:
+                if (indiceDeCampo(filtro.campo)->obtenerCandidatos(filtro.texto, resultado)) {
+                    plan.resuelto = false;
+                } else {
+                    CampoTexto campo = filtro.campo == ConsultaBiblioteca::CAMPO_TITULO ? TEXTO_TITULO : TEXTO_ARTISTA;
+                    columnaTexto.buscar(filtro.texto, 1u << campo, resultado);
+                }
+                break;
+            case ConsultaBiblioteca::CAMPO_ALBUM:
+                columnaTexto.buscar(filtro.texto, 1u << TEXTO_ALBUM, resultado);
+                break;
+            case ConsultaBiblioteca::CAMPO_TEXTO:
+                columnaTexto.buscar(filtro.texto, (1u << NUM_CAMPOS_TEXTO) - 1, resultado);
+                break;
+            case ConsultaBiblioteca::CAMPO_GENERO:
+                plan.canciones.obtenerValores(resultado);
+                break;
+            case ConsultaBiblioteca::CAMPO_ANIO:
+            case ConsultaBiblioteca::CAMPO_DURACION: {
+                CampoOrden campo = filtro.campo == ConsultaBiblioteca::CAMPO_ANIO ? ORDEN_ANIO : ORDEN_DURACION;
+                int inicio;
+                int fin;
+                rangoEnOrden(campo, filtro.minimo, filtro.maximo, inicio, fin);
+
+                resultado.reservar(fin - inicio);
+                for (int posicion = inicio; posicion < fin; posicion++) {
+                    resultado.agregar(ordenes[campo].obtener(posicion));
+                }
+                Ordenamiento<int>::ordenar(resultado);
+                break;
+            }
+        }
+
+        // La columna de texto conserva los campos de las canciones eliminadas
+        descartarEliminadas(resultado);
+    }
+
+    // Verificar un filtro sobre una canción (sin tener en cuenta si está negado)
+    bool cumpleFiltro(int indice, const FiltroPlanificado& plan) const {
+        const ConsultaBiblioteca::Filtro& filtro = *plan.filtro;
+        const Cancion& cancion = canciones.obtener(indice);
+
+        switch (filtro.campo) {
+            case ConsultaBiblioteca::CAMPO_TEXTO:
+                return Busqueda::contiene(cancion.claveTitulo, filtro.texto) ||
+                       Busqueda::contiene(cancion.claveArtista, filtro.texto) ||
+                       Busqueda::contiene(cancion.claveAlbum, filtro.texto);
+            case ConsultaBiblioteca::CAMPO_TITULO:
+                return Busqueda::contiene(cancion.claveTitulo, filtro.texto);
+            case ConsultaBiblioteca::CAMPO_ARTISTA:
+                return Busqueda::contiene(cancion.claveArtista, filtro.texto);
+            case ConsultaBiblioteca::CAMPO_ALBUM:
+                return Busqueda::contiene(cancion.claveAlbum, filtro.texto);
+            case ConsultaBiblioteca::CAMPO_GENERO:
+                return plan.canciones.contiene(indice);
+            case ConsultaBiblioteca::CAMPO_ANIO:
+                return cancion.anio >= filtro.minimo && cancion.anio <= filtro.maximo;
+            case ConsultaBiblioteca::CAMPO_DURACION:
+                return cancion.duracion >= filtro.minimo && cancion.duracion <= filtro.maximo;
+        }
+        return false;
+    }
+
+    // Quitar todas las apariciones de una canción de una secuencia
+    static void quitarDeSecuencia(SecuenciaPersistente<int>& secuencia, int cancion) {
+        for (int i = secuencia.obtenerTamanio() - 1; i >= 0; i--) {
+            if (secuencia.obtener(i) == cancion) {
+                secuencia.eliminar(i);
+            }
+        }
+    }
 
-        // No agregar el vértice origen al resultado
-        if (actual != origen) {
-            resultado.agregar(vertices.obtener(actual));
+    // Quitar de una secuencia las canciones eliminadas
+    void quitarEliminadas(SecuenciaPersistente<int>& secuencia) const {
+        for (int i = secuencia.obtenerTamanio() - 1; i >= 0; i--) {
+            if (!existeCancion(secuencia.obtener(i))) {
+                secuencia.eliminar(i);
+            }
         }
+    }
 
-        // Explorar vecinos
-        Lista<Arista> vecinos = adyacencia.obtener(actual);
-        for (int i = 0; i < vecinos.obtenerTamanio(); i++) {
-            int vecino = vecinos.obtener(i).destino;
-            if (!visitados[vecino]) {
-                dfsRecursivo(vecino, resultado, visitados, origen);
-            }
+    // Agregar una canción al historial olvidando las más antiguas que sobren. Es
+    // O(log limiteHistorial) y, con los nodos reutilizados, no reserva memoria
+    void agregarAlHistorial(int cancion) {
+        historial.agregarAlFinal(cancion);
+        while (historial.obtenerTamanio() > limiteHistorial) {
+            historial.quitarDelFrente();
         }
     }
-};
 
-// ==================== UTILIDADES ====================
+    EstadoReproduccion capturarEstado() const {
+        EstadoReproduccion estado;
+        estado.cola = colaReproduccion;
+        estado.historial = historial;
+        estado.cancionActual = cancionActual;
+        estado.vueltaAleatoria = vueltaAleatoria;
+        estado.inicioAleatorio = inicioAleatorio;
+        estado.pasoAleatorio = pasoAleatorio;
+        estado.eliminadas = numEliminadas;
+        return estado;
+    }
 
-/**
- * @brief Utilidades para manejar caracteres UTF-8 en español
- */
-class UTF8Util {
-public:
-    // Formatea un texto para que tenga un ancho específico
-    static std::string formatearTexto(const std::string& texto, int ancho) {
-        // Verificar límites para evitar errores
-        if (ancho <= 0) {
-            return "";
+    void restaurarEstado(const EstadoReproduccion& estado) {
+        colaReproduccion = estado.cola;
+        historial = estado.historial;
+        cancionActual = estado.cancionActual;
+
+        // Un estado anterior a una eliminación puede nombrar la canción eliminada
+        if (estado.eliminadas != numEliminadas) {
+            quitarEliminadas(colaReproduccion);
+            quitarEliminadas(historial);
+            if (!existeCancion(cancionActual)) {
+                cancionActual = -1;
+            }
         }
-
-        if (texto.length() > static_cast<size_t>(ancho)) {
-            // Asegurar que no excedemos el tamaño del string
-            size_t longitud = std::min(texto.length(), static_cast<size_t>(ancho - 3));
-            return texto.substr(0, longitud) + "...";
+        if (cancionActual == -1) {
+            reproduciendo = false;
         }
 
-        // Limitar el tamaño del padding para evitar strings muy grandes
-        size_t padding = std::min(static_cast<size_t>(ancho - texto.length()), static_cast<size_t>(100));
-        return texto + std::string(padding, ' ');
+        if (estado.vueltaAleatoria != vueltaAleatoria) {
+            permutacionAleatoria.reiniciar(canciones.obtenerTamanio(), semillaVuelta(estado.vueltaAleatoria));
+        }
+        vueltaAleatoria = estado.vueltaAleatoria;
+        inicioAleatorio = estado.inicioAleatorio;
+        pasoAleatorio = estado.pasoAleatorio;
     }
 
-    // Crea una línea de separación
-    static std::string formatearLinea(int longitud) {
-        // Limitar la longitud para evitar strings muy grandes
-        longitud = std::min(longitud, 200);
-        return std::string(longitud, '-');
+    uint64_t semillaVuelta(int vuelta) const {
+        return semillaAleatoria + static_cast<uint64_t>(vuelta) * 0x9e3779b97f4a7c15ULL;
     }
 
-    // Formatea un título centrado
-    static std::string formatearTitulo(const std::string& titulo) {
-        const int ancho = 80;
+    // Empezar una vuelta del modo aleatorio; si se indica una canción, la vuelta parte de ella
+    void prepararVueltaAleatoria(int vuelta, int cancionInicial) {
+        permutacionAleatoria.reiniciar(canciones.obtenerTamanio(), semillaVuelta(vuelta));
+        vueltaAleatoria = vuelta;
+        inicioAleatorio = std::max(0, permutacionAleatoria.posicionDe(cancionInicial));
+        pasoAleatorio = cancionInicial >= 0 ? 0 : -1;
+    }
 
-        // Verificar que el título no sea demasiado largo
-        if (titulo.length() > static_cast<size_t>(ancho)) {
-            return titulo.substr(0, ancho - 3) + "...";
+    // Avanzar una canción en la permutación; al agotarla empieza otra vuelta con otro orden
+    // La permutación recorre todos los identificadores y se saltan los de canciones eliminadas
+    int siguienteAleatoria() {
+        int n = canciones.obtenerTamanio();
+        if (permutacionAleatoria.obtenerTamanio() != n) {
+            // La biblioteca cambió: la vuelta vuelve a empezar en la canción actual
+            prepararVueltaAleatoria(vueltaAleatoria, cancionActual);
+        }
+        if (obtenerNumCanciones() == 0) {
+            return -1;
         }
 
-        int espacios = (ancho - titulo.length()) / 2;
-        espacios = std::max(0, espacios); // Asegurar que no sea negativo
+        int cancion;
+        do {
+            pasoAleatorio++;
+            if (pasoAleatorio >= n) {
+                prepararVueltaAleatoria(vueltaAleatoria + 1, -1);
+                pasoAleatorio = 0;
+            }
 
-        return std::string(espacios, ' ') + titulo;
+            int posicion = inicioAleatorio + pasoAleatorio;
+            cancion = permutacionAleatoria.obtener(posicion >= n ? posicion - n : posicion);
+        } while (canciones.obtener(cancion).eliminada);
+        return cancion;
     }
 
-    // Caracteres especiales en español
-    static std::string A_ACENTO() { return "á"; }
-    static std::string E_ACENTO() { return "é"; }
-    static std::string I_ACENTO() { return "í"; }
-    static std::string O_ACENTO() { return "ó"; }
-    static std::string U_ACENTO() { return "ú"; }
-    static std::string N_TILDE() { return "ñ"; }
-};
+    double pesoCancionMezcla(int indice) const {
+        const Cancion& cancion = canciones.obtener(indice);
+        return (1.0 + std::log(1.0 + std::max(0, cancion.reproducciones))) / (1 + cancion.saltos);
+    }
 
-// ==================== ALGORITMOS ====================
+    double pesoArtistaMezcla(int artista) const {
+        double afinidad = afinidadArtista.obtener(artista);
+        if (afinidad > AFINIDAD_MAXIMA - 1) {
+            afinidad = AFINIDAD_MAXIMA - 1;
+        }
+        return (1.0 + afinidad) * tablasArtista.obtener(artista).obtenerSumaPesos();
+    }
 
-/**
- * @brief Algoritmos de búsqueda
- */
-class Busqueda {
-public:
-    // Verifica si una cadena contiene otra (insensible a mayúsculas/minúsculas)
-    static bool contieneCadenaInsensible(const std::string& texto, const std::string& busqueda) {
-        std::string textoLower = texto;
-        std::string busquedaLower = busqueda;
+    // La mezcla corresponde a la biblioteca actual (agregar o eliminar canciones la descarta)
+    bool mezclaConstruida() const {
+        return artistaDeCancion.obtenerTamanio() == canciones.obtenerTamanio();
+    }
+
+    // Calcular todos los pesos desde cero, O(n); las tablas de cada artista se
+    // construyen la primera vez que se elige ese artista
+    void construirMezcla() {
+        int numArtistas = cancionesDeArtista.obtenerTamanio();
+        tablaMezcla.reiniciar(numArtistas, semillaAleatoria);
+        tablasArtista.vaciar();
+        tablasArtista.reservar(numArtistas);
+        afinidadArtista.vaciar();
+        afinesMezcla.vaciar();
+        recientesMezcla.vaciar();
+
+        artistaDeCancion.vaciar();
+        posicionEnArtista.vaciar();
+        for (int i = 0; i < canciones.obtenerTamanio(); i++) {
+            artistaDeCancion.agregar(-1);
+            posicionEnArtista.agregar(-1);
+        }
 
-        // Convertir a minúsculas
-        std::transform(textoLower.begin(), textoLower.end(), textoLower.begin(),
-                      [](unsigned char c){ return std::tolower(c); });
-        std::transform(busquedaLower.begin(), busquedaLower.end(), busquedaLower.begin(),
-                      [](unsigned char c){ return std::tolower(c); });
+        for (int artista = 0; artista < numArtistas; artista++) {
+            const Lista<int>& suyas = cancionesDeArtista.obtener(artista);
+            TablaAlias& tabla = tablasArtista.emplazar();
+            tabla.reiniciar(suyas.obtenerTamanio(), semillaAleatoria + artista + 1);
+            for (int j = 0; j < suyas.obtenerTamanio(); j++) {
+                artistaDeCancion.obtener(suyas.obtener(j)) = artista;
+                posicionEnArtista.obtener(suyas.obtener(j)) = j;
+                tabla.establecerPeso(j, pesoCancionMezcla(suyas.obtener(j)));
+            }
 
-        // Buscar subcadena
-        return textoLower.find(busquedaLower) != std::string::npos;
+            afinidadArtista.agregar(0.0);
+            for (int i = 0; i < VECINOS_AFINES; i++) {
+                afinesMezcla.agregar(-2);
+            }
+            tablaMezcla.establecerPeso(artista, pesoArtistaMezcla(artista));
+        }
     }
-};
 
-/**
- * @brief Algoritmos de ordenamiento
- */
-template <typename T>
-class Ordenamiento {
-public:
-    // Ordena una lista por un campo específico
-    static void ordenarPorCampo(Lista<T>& lista,
-                              std::function<bool(const T&, const T&)> comparador,
-                              bool ascendente = true) {
-        int n = lista.obtenerTamanio();
+    // Los VECINOS_AFINES artistas unidos por las aristas más pesadas del grafo (los géneros
+    // no tienen canciones); se calculan una vez por artista y los huecos que sobran valen -1
+    const int* obtenerAfinesMezcla(int artista) {
+        int* afines = &afinesMezcla.obtener(artista * VECINOS_AFINES);
+        if (afines[0] != -2) {
+            return afines;
+        }
 
-        for (int i = 0; i < n - 1; i++) {
-            for (int j = 0; j < n - i - 1; j++) {
-                T elemento1 = lista.obtener(j);
-                T elemento2 = lista.obtener(j + 1);
+        int pesos[VECINOS_AFINES];
+        int encontrados = 0;
+        const Lista<int>& suyas = cancionesDeArtista.obtener(artista);
+        int vertice = suyas.obtenerTamanio() > 0
+                          ? grafoAfinidad.buscarVertice(canciones.obtener(suyas.obtener(0)).artista)
+                          : -1;
+
+        if (vertice != -1) {
+            for (const Grafo<VistaCadena>::Arista& arista : grafoAfinidad.obtenerAristas(vertice)) {
+                if (encontrados == VECINOS_AFINES && pesos[VECINOS_AFINES - 1] >= arista.peso) {
+                    continue;
+                }
 
-                bool debeIntercambiar = ascendente ?
-                    comparador(elemento2, elemento1) :
-                    comparador(elemento1, elemento2);
+                const int* vecino = posicionArtista.buscar(grafoAfinidad.obtenerVertice(arista.destino));
+                if (!vecino || *vecino == artista) {
+                    continue;
+                }
 
-                if (debeIntercambiar) {
-                    lista.modificar(j, elemento2);
-                    lista.modificar(j + 1, elemento1);
+                int i = encontrados < VECINOS_AFINES ? encontrados++ : VECINOS_AFINES - 1;
+                afines[i] = *vecino;
+                pesos[i] = arista.peso;
+                for (; i > 0 && pesos[i - 1] < pesos[i]; i--) {
+                    std::swap(afines[i - 1], afines[i]);
+                    std::swap(pesos[i - 1], pesos[i]);
                 }
             }
         }
+
+        for (int i = encontrados; i < VECINOS_AFINES; i++) {
+            afines[i] = -1;
+        }
+        return afines;
     }
-};
 
-// ==================== MODELOS ====================
+    void sumarAfinidad(int artista, double delta) {
+        afinidadArtista.obtener(artista) += delta;
+        tablaMezcla.establecerPeso(artista, pesoArtistaMezcla(artista));
+    }
 
-/**
- * @brief Estructura que representa una canción
- */
-struct Cancion {
-    std::string titulo;           // Título de la canción
-    std::string artista;          // Artista o intérprete
-    std::string album;            // Álbum al que pertenece
-    int anio;                     // Año de lanzamiento
-    int duracion;                 // Duración en segundos
-    Lista<std::string> generos;   // Géneros musicales
+    // Una canción que entra (signo 1) o sale (signo -1) de las recientes sube (o deja de
+    // subir) a su artista y a sus artistas más afines
+    void ajustarAfinidadMezcla(int cancion, int signo) {
+        int artista = artistaDeCancion.obtener(cancion);
+        sumarAfinidad(artista, signo * 1.0);
 
-    // Constructor por defecto
-    Cancion() : titulo(""), artista(""), album(""), anio(0), duracion(0) {}
+        const int* afines = obtenerAfinesMezcla(artista);
+        for (int i = 0; i < VECINOS_AFINES && afines[i] != -1; i++) {
+            sumarAfinidad(afines[i], signo * 0.5);
+        }
+    }
 
-    // Constructor con parámetros
-    Cancion(const std::string& _titulo, const std::string& _artista, const std::string& _album,
-            int _anio, int _duracion)
-        : titulo(_titulo), artista(_artista), album(_album), anio(_anio), duracion(_duracion) {}
+    // Contar una reproducción de la canción que empieza a sonar: sube su peso en la mezcla
+    // inteligente, como saltarCancion lo baja, y su puntuación en el autocompletado
+    void contarReproduccion(int cancion) {
+        if (cancion < 0) {
+            return;
+        }
 
-    // Métodos de comparación para ordenamiento
-    bool compararPorTitulo(const Cancion& otra) const {
-        return titulo < otra.titulo;
+        Cancion& actual = canciones.obtener(cancion);
+        actual.reproducciones++;
+        indicePrefijos.actualizarPuntuacion(cancion, actual.reproducciones);
+        if (mezclaInteligente && mezclaConstruida()) {
+            int artista = artistaDeCancion.obtener(cancion);
+            tablasArtista.obtener(artista).establecerPeso(posicionEnArtista.obtener(cancion),
+                                                          pesoCancionMezcla(cancion));
+            tablaMezcla.establecerPeso(artista, pesoArtistaMezcla(artista));
+        }
     }
 
-    bool compararPorArtista(const Cancion& otra) const {
-        return artista < otra.artista;
-    }
+    // Anotar que empezó a sonar una canción
+    void registrarEnMezcla(int cancion) {
+        if (!mezclaInteligente || cancion < 0 || !mezclaConstruida()) {
+            return;
+        }
 
-    bool compararPorAlbum(const Cancion& otra) const {
-        return album < otra.album;
+        recientesMezcla.agregarAlFinal(cancion);
+        ajustarAfinidadMezcla(cancion, 1);
+        if (recientesMezcla.obtenerTamanio() > RECIENTES_MEZCLA) {
+            ajustarAfinidadMezcla(recientesMezcla.frente(), -1);
+            recientesMezcla.quitarDelFrente();
+        }
     }
 
-    bool compararPorAnio(const Cancion& otra) const {
-        return anio < otra.anio;
-    }
+    // Elegir por peso un artista y una de sus canciones, evitando las que sonaron hace poco
+    int siguienteInteligente() {
+        if (!mezclaConstruida()) {
+            // La biblioteca cambió: los pesos vuelven a calcularse
+            construirMezcla();
+        }
 
-    // Operadores de comparación
-    bool operator==(const Cancion& otra) const {
-        return titulo == otra.titulo && artista == otra.artista;
-    }
+        int elegida = -1;
+        for (int intento = 0; intento < 4 * RECIENTES_MEZCLA; intento++) {
+            int artista = tablaMezcla.muestrear();
+            if (artista == -1) {
+                return -1;
+            }
+            elegida = cancionesDeArtista.obtener(artista).obtener(tablasArtista.obtener(artista).muestrear());
 
-    bool operator!=(const Cancion& otra) const {
-        return !(*this == otra);
+            bool reciente = false;
+            for (int i = 0; i < recientesMezcla.obtenerTamanio() && !reciente; i++) {
+                reciente = recientesMezcla.obtener(i) == elegida;
+            }
+            if (!reciente) {
+                break;
+            }
+        }
+        return elegida;
     }
 
-    // Método para formatear la duración
-    std::string obtenerDuracionFormateada() const {
-        int minutos = duracion / 60;
-        int segundos = duracion % 60;
-        char buffer[10];
-        sprintf(buffer, "%02d:%02d", minutos, segundos);
-        return std::string(buffer);
+    // Guardar el estado antes de una acción; una acción nueva descarta lo deshecho
+    void guardarEstado() {
+        estadosAnteriores.apilar(capturarEstado());
+        estadosDeshechos.vaciar();
     }
-};
-
-/**
- * @brief Estructura que representa una lista de reproducción
- */
-struct ListaReproduccion {
-    std::string nombre;           // Nombre de la lista de reproducción
-    std::string descripcion;      // Descripción opcional
-    Lista<int> canciones;         // Índices de canciones en la biblioteca
 
-    // Constructor por defecto
-    ListaReproduccion() : nombre("Nueva Lista"), descripcion("") {}
+public:
+    // Constructor
+    explicit ReproductorMusica(const std::string& rutaBiblioteca = "library.dat",
+                               int capacidadHistorial = CAPACIDAD_HISTORIAL)
+        : numEliminadas(0),
+          limiteHistorial(std::max(1, capacidadHistorial)),
+          columnaTexto(NUM_CAMPOS_TEXTO),
+          ordenActual(ORDEN_INSERCION),
+          ordenAscendente(true),
+          cancionActual(-1),
+          reproduciendo(false),
+          modoAleatorio(false),
+          semillaAleatoria(0),
+          vueltaAleatoria(0),
+          inicioAleatorio(0),
+          pasoAleatorio(0),
+          mezclaInteligente(false),
+          tablaMezcla(AFINIDAD_MAXIMA),
+          estadosAnteriores(PASOS_DESHACER),
+          estadosDeshechos(PASOS_DESHACER) {
+
+        for (int campo = 0; campo < NUM_ORDENES; campo++) {
+            ordenConstruido[campo] = false;
+        }
 
-    // Constructor con nombre
-    ListaReproduccion(const std::string& _nombre) : nombre(_nombre), descripcion("") {}
+        cargarBiblioteca(rutaBiblioteca);
+        cargarListasFicticias();
+        construirGrafoAfinidad();
+    }
 
-    // Constructor completo
-    ListaReproduccion(const std::string& _nombre, const std::string& _descripcion) :
-        nombre(_nombre), descripcion(_descripcion) {}
+    // Métodos para gestionar canciones
+    // Los textos de la canción se copian al almacén del reproductor, así que
+    // basta con que sean válidos durante la llamada
+    void agregarCancion(const Cancion& cancion) {
+        Cancion copia = cancion;
+        copia.titulo = almacenTexto.guardar(cancion.titulo);
+        copia.artista = almacenTexto.guardar(cancion.artista);
+        copia.album = almacenTexto.guardar(cancion.album);
+        copia.ruta = almacenTexto.guardar(cancion.ruta);
+        copia.generos = guardarGeneros(cancion.generos);
+        copia.eliminada = false;
+        calcularClaves(copia);
+        canciones.agregar(copia);
+        indexarCancion(canciones.obtenerTamanio() - 1);
+        agregarAOrdenes();
 
-    // Agrega una canción a la lista de reproducción
-    bool agregarCancion(int indiceCancion) {
-        if (canciones.contiene(indiceCancion)) {
-            return false;
+        try {
+            actualizarAfinidad(copia, 1);
+        } catch (const std::exception& e) {
+            std::cerr << "Error al actualizar grafo de afinidad: " << e.what() << std::endl;
         }
 
-        canciones.agregar(indiceCancion);
-        return true;
+        // Los pesos de la mezcla inteligente se recalculan en la próxima elección
+        artistaDeCancion.vaciar();
     }
 
-    // Elimina una canción de la lista de reproducción
-    bool eliminarCancion(int indiceCancion) {
-        int posicion = canciones.buscar(indiceCancion);
-        if (posicion == -1) {
+    // Eliminar una canción de la biblioteca
+    // La canción deja su hueco y las demás conservan su identificador; se quita de las
+    // listas de reproducción, la cola y el historial. Los estados guardados para deshacer
+    // se conservan y la descartan al restaurarse
+    bool eliminarCancion(int indice) {
+        if (!existeCancion(indice)) {
             return false;
         }
 
-        canciones.eliminar(posicion);
-        return true;
-    }
+        try {
+            actualizarAfinidad(canciones.obtener(indice), -1);
+            for (int campo = ORDEN_INSERCION; campo < NUM_ORDENES; campo++) {
+                if (ordenConstruido[campo]) {
+                    ordenes[campo].eliminar(posicionEnOrden(static_cast<CampoOrden>(campo), indice));
+                }
+            }
+            desindexarCancion(indice);
+            canciones.obtener(indice).eliminada = true;
+            numEliminadas++;
+            construirOrden(ORDEN_INSERCION);
 
-    // Verifica si la lista contiene una canción específica
-    bool contieneCancion(int indiceCancion) const {
-        return canciones.contiene(indiceCancion);
-    }
+            for (ListaReproduccion& lista : listasReproduccion) {
+                lista.eliminarCancion(indice);
+            }
 
-    // Obtiene el número de canciones en la lista
-    int obtenerNumCanciones() const {
-        return canciones.obtenerTamanio();
+            quitarDeSecuencia(colaReproduccion, indice);
+            quitarDeSecuencia(historial, indice);
+            artistaDeCancion.vaciar();
+
+            if (cancionActual == indice) {
+                cancionActual = -1;
+                reproduciendo = false;
+            }
+
+            return true;
+        } catch (const std::exception& e) {
+            std::cerr << "Error al eliminar canción: " << e.what() << std::endl;
+            return false;
+        }
     }
 
-    // Vacía la lista de reproducción
-    void vaciar() {
-        canciones.vaciar();
+    const Cancion& obtenerCancion(int indice) const {
+        if (!existeCancion(indice)) {
+            // Devolver una canción vacía en caso de error
+            static const Cancion cancionVacia;
+            return cancionVacia;
+        }
+        return canciones.obtener(indice);
     }
-};
 
-// ==================== REPRODUCTOR DE MÚSICA ====================
+    // Verificar que un identificador corresponde a una canción de la biblioteca
+    bool existeCancion(int indice) const {
+        return indice >= 0 && indice < canciones.obtenerTamanio() && !canciones.obtener(indice).eliminada;
+    }
 
-/**
- * @brief Clase principal del reproductor de música
- */
-class ReproductorMusica {
-private:
-    Lista<Cancion> canciones;
-    Lista<ListaReproduccion> listasReproduccion;
-    Pila<int> historial;
-    Cola<int> colaReproduccion;
-    Grafo<std::string> grafoAfinidad;
+    // Número de canciones de la biblioteca (los identificadores pueden llegar más lejos
+    // si se eliminó alguna)
+    int obtenerNumCanciones() const {
+        return canciones.obtenerTamanio() - numEliminadas;
+    }
 
-    int cancionActual;
-    bool reproduciendo;
+    // Métodos para búsqueda de canciones
+    // Con tolerancia > 0 la búsqueda admite ese número de errores y ordena por cercanía
+    Lista<int> buscarCancionesPorTitulo(const std::string& titulo, int tolerancia = 0) const {
+        Lista<int> resultados;
 
-    // Método para cargar datos ficticios
-    void cargarDatosFicticios() {
         try {
-            // Canciones ficticias
-            Cancion cancion1("Bohemian Rhapsody", "Queen", "A Night at the Opera", 1975, 355);
-            cancion1.generos.agregar("Rock");
-            cancion1.generos.agregar("Progresivo");
-
-            Cancion cancion2("Imagine", "John Lennon", "Imagine", 1971, 183);
-            cancion2.generos.agregar("Rock");
-            cancion2.generos.agregar("Pop");
-
-            Cancion cancion3("Billie Jean", "Michael Jackson", "Thriller", 1982, 294);
-            cancion3.generos.agregar("Pop");
-            cancion3.generos.agregar("Funk");
-
-            Cancion cancion4("Hotel California", "Eagles", "Hotel California", 1976, 390);
-            cancion4.generos.agregar("Rock");
-
-            Cancion cancion5("Sweet Child O' Mine", "Guns N' Roses", "Appetite for Destruction", 1987, 356);
-            cancion5.generos.agregar("Rock");
-            cancion5.generos.agregar("Hard Rock");
-
-            Cancion cancion6("Smells Like Teen Spirit", "Nirvana", "Nevermind", 1991, 301);
-            cancion6.generos.agregar("Grunge");
-            cancion6.generos.agregar("Rock Alternativo");
-
-            Cancion cancion7("Like a Rolling Stone", "Bob Dylan", "Highway 61 Revisited", 1965, 379);
-            cancion7.generos.agregar("Folk Rock");
-
-            Cancion cancion8("I Want to Hold Your Hand", "The Beatles", "Meet the Beatles!", 1963, 146);
-            cancion8.generos.agregar("Rock");
-            cancion8.generos.agregar("Pop");
-
-            Cancion cancion9("Purple Haze", "Jimi Hendrix", "Are You Experienced", 1967, 170);
-            cancion9.generos.agregar("Rock Psicodélico");
-            cancion9.generos.agregar("Hard Rock");
-
-            Cancion cancion10("Johnny B. Goode", "Chuck Berry", "Chuck Berry Is on Top", 1958, 161);
-            cancion10.generos.agregar("Rock and Roll");
-
-            // Agregar canciones a la biblioteca
-            agregarCancion(cancion1);
-            agregarCancion(cancion2);
-            agregarCancion(cancion3);
-            agregarCancion(cancion4);
-            agregarCancion(cancion5);
-            agregarCancion(cancion6);
-            agregarCancion(cancion7);
-            agregarCancion(cancion8);
-            agregarCancion(cancion9);
-            agregarCancion(cancion10);
-
-            // Listas de reproducción ficticias
-            ListaReproduccion lista1("Clásicos del Rock", "Las mejores canciones de rock de todos los tiempos");
-            lista1.agregarCancion(0);  // Bohemian Rhapsody
-            lista1.agregarCancion(3);  // Hotel California
-            lista1.agregarCancion(4);  // Sweet Child O' Mine
-            lista1.agregarCancion(5);  // Smells Like Teen Spirit
+            if (tolerancia > 0) {
+                resultados = buscarAproximadoEnCampo(indiceTitulos, TEXTO_TITULO, titulo, tolerancia);
+            } else {
+                resultados = buscarEnCampo(indiceTitulos, &Cancion::claveTitulo, TEXTO_TITULO, titulo);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error en búsqueda por título: " << e.what() << std::endl;
+        }
 
-            ListaReproduccion lista2("Pop Hits", "Éxitos del pop a través de las décadas");
-            lista2.agregarCancion(1);  // Imagine
-            lista2.agregarCancion(2);  // Billie Jean
-            lista2.agregarCancion(7);  // I Want to Hold Your Hand
+        return resultados;
+    }
 
-            // Agregar listas a la biblioteca
-            listasReproduccion.agregar(lista1);
-            listasReproduccion.agregar(lista2);
+    Lista<int> buscarCancionesPorArtista(const std::string& artista, int tolerancia = 0) const {
+        Lista<int> resultados;
 
-            // Construir grafo de afinidad
-            construirGrafoAfinidad();
+        try {
+            if (tolerancia > 0) {
+                resultados = buscarAproximadoEnCampo(indiceArtistas, TEXTO_ARTISTA, artista, tolerancia);
+            } else {
+                resultados = buscarEnCampo(indiceArtistas, &Cancion::claveArtista, TEXTO_ARTISTA, artista);
+            }
         } catch (const std::exception& e) {
-            std::cerr << "Error al cargar datos ficticios: " << e.what() << std::endl;
+            std::cerr << "Error en búsqueda por artista: " << e.what() << std::endl;
         }
+
+        return resultados;
     }
 
-    // Construir grafo de afinidad para recomendaciones
-    void construirGrafoAfinidad() {
+    // Buscar con una consulta de varios campos (ver ConsultaBiblioteca)
+    // Los filtros de género se combinan en un solo mapa de bits (rock AND NOT pop). Después,
+    // el filtro más selectivo según los índices genera los candidatos, los demás índices
+    // (trigramas, géneros) los recortan y solo lo que queda se verifica canción a canción.
+    // Devuelve los identificadores en orden creciente
+    Lista<int> buscarConConsulta(const std::string& texto) {
+        Lista<int> resultados;
+
         try {
-            grafoAfinidad.vaciar();
+            Lista<ConsultaBiblioteca::Filtro> filtros = ConsultaBiblioteca::analizar(texto);
+            if (filtros.estaVacia()) {
+                return resultados;
+            }
 
-            // Agregar todos los artistas y géneros como vértices
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                Cancion cancion = canciones.obtener(i);
+            Lista<FiltroPlanificado> plan;
+            for (const ConsultaBiblioteca::Filtro& filtro : filtros) {
+                planificarFiltro(filtro, plan.emplazar());
+            }
 
-                if (!grafoAfinidad.existeVertice(cancion.artista)) {
-                    grafoAfinidad.agregarVertice(cancion.artista);
+            FiltroPlanificado* generos = nullptr;
+            for (FiltroPlanificado& filtro : plan) {
+                if (filtro.filtro->campo == ConsultaBiblioteca::CAMPO_GENERO && !filtro.filtro->negado) {
+                    generos = &filtro;
+                    break;
                 }
-
-                for (int j = 0; j < cancion.generos.obtenerTamanio(); j++) {
-                    std::string genero = cancion.generos.obtener(j);
-                    if (!grafoAfinidad.existeVertice(genero)) {
-                        grafoAfinidad.agregarVertice(genero);
+            }
+            if (generos != nullptr) {
+                for (FiltroPlanificado& filtro : plan) {
+                    if (&filtro == generos || filtro.filtro->campo != ConsultaBiblioteca::CAMPO_GENERO) {
+                        continue;
                     }
+                    generos->canciones = filtro.filtro->negado
+                                             ? MapaBits::diferencia(generos->canciones, filtro.canciones)
+                                             : MapaBits::interseccion(generos->canciones, filtro.canciones);
+                    filtro.resuelto = true;
                 }
+                generos->estimacion = generos->canciones.cardinalidad();
             }
 
-            // Conectar artistas con sus géneros
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                Cancion cancion = canciones.obtener(i);
-
-                for (int j = 0; j < cancion.generos.obtenerTamanio(); j++) {
-                    std::string genero = cancion.generos.obtener(j);
-                    grafoAfinidad.agregarArista(cancion.artista, genero);
-                    grafoAfinidad.agregarArista(genero, cancion.artista);
+            // Filtros pendientes, del más selectivo al menos selectivo
+            Lista<int> orden;
+            for (int i = 0; i < plan.obtenerTamanio(); i++) {
+                if (!plan.obtener(i).resuelto) {
+                    orden.agregar(i);
                 }
             }
+            Ordenamiento<FiltroPlanificado>::ordenarIndices(plan, orden,
+                [](const FiltroPlanificado& a, const FiltroPlanificado& b) {
+                    return a.estimacion < b.estimacion;
+                });
 
-            // Conectar artistas que comparten géneros
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                Cancion cancion1 = canciones.obtener(i);
-
-                for (int j = i + 1; j < canciones.obtenerTamanio(); j++) {
-                    Cancion cancion2 = canciones.obtener(j);
-
-                    if (cancion1.artista != cancion2.artista) {
-                        bool compartenGenero = false;
-
-                        for (int k = 0; k < cancion1.generos.obtenerTamanio() && !compartenGenero; k++) {
-                            std::string genero1 = cancion1.generos.obtener(k);
+            materializarFiltro(plan.obtener(orden.obtener(0)), resultados);
 
-                            for (int l = 0; l < cancion2.generos.obtenerTamanio() && !compartenGenero; l++) {
-                                std::string genero2 = cancion2.generos.obtener(l);
+            for (int i = 1; i < orden.obtenerTamanio() && !resultados.estaVacia(); i++) {
+                FiltroPlanificado& siguiente = plan.obtener(orden.obtener(i));
+                if (siguiente.filtro->negado) {
+                    continue;
+                }
 
-                                if (genero1 == genero2) {
-                                    compartenGenero = true;
-                                }
-                            }
+                const IndiceTexto* indice = indiceDeCampo(siguiente.filtro->campo);
+                if (indice != nullptr) {
+                    indice->filtrarCandidatos(siguiente.filtro->texto, resultados);
+                } else if (siguiente.filtro->campo == ConsultaBiblioteca::CAMPO_GENERO) {
+                    Lista<int> enGeneros;
+                    for (int cancion : resultados) {
+                        if (siguiente.canciones.contiene(cancion)) {
+                            enGeneros.agregar(cancion);
                         }
+                    }
+                    resultados = std::move(enGeneros);
+                    siguiente.resuelto = true;
+                }
+            }
 
-                        if (compartenGenero) {
-                            grafoAfinidad.agregarArista(cancion1.artista, cancion2.artista);
-                            grafoAfinidad.agregarArista(cancion2.artista, cancion1.artista);
-                        }
+            // Predicados residuales
+            Lista<int> verificados;
+            for (int cancion : resultados) {
+                bool cumple = true;
+                for (int i = 0; i < plan.obtenerTamanio() && cumple; i++) {
+                    const FiltroPlanificado& filtro = plan.obtener(i);
+                    if (!filtro.resuelto) {
+                        cumple = cumpleFiltro(cancion, filtro) != filtro.filtro->negado;
                     }
                 }
+                if (cumple) {
+                    verificados.agregar(cancion);
+                }
             }
+            resultados = std::move(verificados);
         } catch (const std::exception& e) {
-            std::cerr << "Error al construir grafo de afinidad: " << e.what() << std::endl;
+            std::cerr << "Error en la consulta: " << e.what() << std::endl;
+            resultados.vaciar();
         }
+
+        return resultados;
     }
 
-public:
-    // Constructor
-    ReproductorMusica()
-        : cancionActual(-1),
-          reproduciendo(false) {
+    // Contar cuántas canciones de la selección tiene cada género (por id del diccionario)
+    Lista<int> contarGeneros(const Lista<int>& seleccion) const {
+        MapaBits conjunto;
+        for (int cancion : seleccion) {
+            conjunto.agregar(cancion);
+        }
 
-        cargarDatosFicticios();
+        Lista<int> conteos;
+        for (const MapaBits& generos : cancionesDeGenero) {
+            conteos.agregar(MapaBits::cardinalidadInterseccion(conjunto, generos));
+        }
+        return conteos;
     }
 
-    // Métodos para gestionar canciones
-    void agregarCancion(const Cancion& cancion) {
-        canciones.agregar(cancion);
+    VistaCadena obtenerNombreGenero(int id) const {
+        return diccionarioGeneros.obtenerNombre(id);
     }
 
-    Cancion obtenerCancion(int indice) const {
-        if (indice < 0 || indice >= canciones.obtenerTamanio()) {
-            // Devolver una canción vacía en caso de error
-            return Cancion();
+    // Tolerancia razonable para una búsqueda aproximada según la longitud de la consulta
+    static int toleranciaSugerida(const std::string& texto) {
+        int longitud = static_cast<int>(Colacion::normalizar(texto).length());
+        if (longitud < 4) {
+            return 0;
         }
-        return canciones.obtener(indice);
-    }
-
-    int obtenerNumCanciones() const {
-        return canciones.obtenerTamanio();
+        return longitud < 8 ? 1 : 2;
     }
 
-    // Métodos para búsqueda de canciones
-    Lista<int> buscarCancionesPorTitulo(const std::string& titulo) const {
+    // Buscar en título, artista y álbum a la vez recorriendo la columna de texto completa
+    Lista<int> buscarCancionesEnTodo(const std::string& texto) const {
         Lista<int> resultados;
 
         try {
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                Cancion cancion = canciones.obtener(i);
-                if (Busqueda::contieneCadenaInsensible(cancion.titulo, titulo)) {
-                    resultados.agregar(i);
-                }
-            }
+            std::string consulta = Colacion::normalizar(texto);
+            columnaTexto.buscar(consulta, (1u << NUM_CAMPOS_TEXTO) - 1, resultados);
+            descartarEliminadas(resultados);
         } catch (const std::exception& e) {
-            std::cerr << "Error en búsqueda por título: " << e.what() << std::endl;
+            std::cerr << "Error en búsqueda general: " << e.what() << std::endl;
         }
 
         return resultados;
     }
 
-    Lista<int> buscarCancionesPorArtista(const std::string& artista) const {
-        Lista<int> resultados;
+    // Métodos para autocompletar: la posición se extiende carácter a carácter
+    TriePrefijos::Posicion iniciarAutocompletado() const {
+        return indicePrefijos.raiz();
+    }
+
+    bool avanzarAutocompletado(TriePrefijos::Posicion& posicion, char c) const {
+        return indicePrefijos.avanzar(posicion, c);
+    }
+
+    // Canciones más reproducidas cuyo título, artista o álbum continúa el prefijo
+    Lista<int> obtenerSugerencias(const TriePrefijos::Posicion& posicion, int cantidad) const {
+        Lista<int> sugerencias;
 
         try {
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                Cancion cancion = canciones.obtener(i);
-                if (Busqueda::contieneCadenaInsensible(cancion.artista, artista)) {
-                    resultados.agregar(i);
-                }
-            }
+            sugerencias = indicePrefijos.obtenerMejores(posicion, cantidad);
         } catch (const std::exception& e) {
-            std::cerr << "Error en búsqueda por artista: " << e.what() << std::endl;
+            std::cerr << "Error al obtener sugerencias: " << e.what() << std::endl;
         }
 
-        return resultados;
+        return sugerencias;
     }
 
     // Métodos para ordenamiento
-    void ordenarPorTitulo(bool ascendente = true) {
+    // Cambiar el orden de la vista de la biblioteca; las canciones no se mueven
+    void establecerOrden(CampoOrden campo, bool ascendente = true) {
         try {
-            Ordenamiento<Cancion>::ordenarPorCampo(canciones,
-                [](const Cancion& a, const Cancion& b) -> bool {
-                    return a.compararPorTitulo(b);
-                }, ascendente);
+            construirOrden(campo);
+            ordenActual = campo;
+            ordenAscendente = ascendente;
         } catch (const std::exception& e) {
-            std::cerr << "Error al ordenar por título: " << e.what() << std::endl;
+            std::cerr << "Error al ordenar la biblioteca: " << e.what() << std::endl;
         }
     }
 
+    void ordenarPorTitulo(bool ascendente = true) {
+        establecerOrden(ORDEN_TITULO, ascendente);
+    }
+
     void ordenarPorArtista(bool ascendente = true) {
-        try {
-            Ordenamiento<Cancion>::ordenarPorCampo(canciones,
-                [](const Cancion& a, const Cancion& b) -> bool {
-                    return a.compararPorArtista(b);
-                }, ascendente);
-        } catch (const std::exception& e) {
-            std::cerr << "Error al ordenar por artista: " << e.what() << std::endl;
+        establecerOrden(ORDEN_ARTISTA, ascendente);
+    }
+
+    // Identificador de la canción en una posición de la vista ordenada
+    int obtenerCancionEnOrden(int posicion) const {
+        int n = obtenerNumCanciones();
+        if (posicion < 0 || posicion >= n) {
+            return -1;
+        }
+
+        int ascendente = ordenAscendente ? posicion : n - 1 - posicion;
+        if (ordenActual == ORDEN_INSERCION && !ordenConstruido[ORDEN_INSERCION]) {
+            return ascendente;
+        }
+        return ordenes[ordenActual].obtener(ascendente);
+    }
+
+    // Posición de una canción en la vista ordenada (-1 si no existe)
+    int obtenerPosicionEnOrden(int indice) const {
+        if (!existeCancion(indice)) {
+            return -1;
         }
+        int n = obtenerNumCanciones();
+
+        int posicion = posicionEnOrden(ordenActual, indice);
+        if (posicion == -1) {
+            return -1;
+        }
+        return ordenAscendente ? posicion : n - 1 - posicion;
     }
 
     // Métodos para reproducción
     bool reproducir(int indice) {
-        if (indice >= 0 && indice < canciones.obtenerTamanio()) {
+        if (existeCancion(indice)) {
+            guardarEstado();
             if (cancionActual >= 0) {
-                historial.apilar(cancionActual);
+                agregarAlHistorial(cancionActual);
             }
             cancionActual = indice;
+            contarReproduccion(cancionActual);
+            registrarEnMezcla(cancionActual);
             reproduciendo = true;
             return true;
         }
@@ -1030,52 +6863,220 @@ public:
 
     bool siguiente() {
         if (!colaReproduccion.estaVacia()) {
+            guardarEstado();
             if (cancionActual >= 0) {
-                historial.apilar(cancionActual);
+                agregarAlHistorial(cancionActual);
             }
             cancionActual = colaReproduccion.frente();
-            colaReproduccion.desencolar();
+            colaReproduccion.quitarDelFrente();
+            contarReproduccion(cancionActual);
+            registrarEnMezcla(cancionActual);
+            reproduciendo = true;
+            return true;
+        } else if (modoAleatorio && obtenerNumCanciones() > 0) {
+            guardarEstado();
+            if (cancionActual >= 0) {
+                agregarAlHistorial(cancionActual);
+            }
+            cancionActual = mezclaInteligente ? siguienteInteligente() : siguienteAleatoria();
+            contarReproduccion(cancionActual);
+            registrarEnMezcla(cancionActual);
             reproduciendo = true;
             return true;
-        } else if (cancionActual >= 0 && cancionActual < canciones.obtenerTamanio() - 1) {
-            historial.apilar(cancionActual);
-            cancionActual++;
+        } else if (cancionActual >= 0) {
+            // Sin cola, continuar con la siguiente canción de la vista ordenada
+            int siguienteCancion = obtenerCancionEnOrden(obtenerPosicionEnOrden(cancionActual) + 1);
+            if (siguienteCancion == -1) {
+                return false;
+            }
+
+            guardarEstado();
+            agregarAlHistorial(cancionActual);
+            cancionActual = siguienteCancion;
+            contarReproduccion(cancionActual);
+            registrarEnMezcla(cancionActual);
             reproduciendo = true;
             return true;
         }
         return false;
     }
 
+    // La canción que sonaba vuelve al frente de la cola, así que siguiente() la retoma.
+    // También en modo aleatorio se vuelve por el historial, no por la permutación: quitar
+    // su última canción y agregar al frente de la cola son O(log n) en las secuencias persistentes
     bool anterior() {
         if (!historial.estaVacia()) {
+            guardarEstado();
             if (cancionActual >= 0) {
-                colaReproduccion.encolar(cancionActual);
+                colaReproduccion.agregarAlFrente(cancionActual);
             }
-            cancionActual = historial.cima();
-            historial.desapilar();
+            cancionActual = historial.obtener(historial.obtenerTamanio() - 1);
+            historial.eliminar(historial.obtenerTamanio() - 1);
+            contarReproduccion(cancionActual);
+            registrarEnMezcla(cancionActual);
             reproduciendo = true;
             return true;
         }
         return false;
     }
 
+    // Deshacer la última acción sobre la canción actual, la cola o el historial
+    bool deshacer() {
+        if (estadosAnteriores.estaVacia()) {
+            return false;
+        }
+
+        estadosDeshechos.apilar(capturarEstado());
+        restaurarEstado(estadosAnteriores.cima());
+        estadosAnteriores.desapilar();
+        return true;
+    }
+
+    bool rehacer() {
+        if (estadosDeshechos.estaVacia()) {
+            return false;
+        }
+
+        estadosAnteriores.apilar(capturarEstado());
+        restaurarEstado(estadosDeshechos.cima());
+        estadosDeshechos.desapilar();
+        return true;
+    }
+
+    int obtenerPasosDeshacer() const {
+        return estadosAnteriores.obtenerTamanio();
+    }
+
+    int obtenerPasosRehacer() const {
+        return estadosDeshechos.obtenerTamanio();
+    }
+
     int obtenerCancionActual() const {
         return cancionActual;
     }
 
+    // Modo aleatorio: la misma semilla da siempre el mismo orden. La vuelta empieza
+    // en la canción actual y recorre toda la biblioteca antes de repetir
+    void activarModoAleatorio(uint64_t semilla) {
+        modoAleatorio = true;
+        mezclaInteligente = false;
+        semillaAleatoria = semilla;
+        prepararVueltaAleatoria(0, cancionActual);
+    }
+
+    // Mezcla inteligente: cada siguiente() sin cola elige en O(1) con una tabla de alias,
+    // favoreciendo lo más escuchado y lo afín a lo reciente, y evitando lo saltado
+    void activarMezclaInteligente(uint64_t semilla) {
+        modoAleatorio = true;
+        mezclaInteligente = true;
+        semillaAleatoria = semilla;
+        construirMezcla();
+        registrarEnMezcla(cancionActual);
+    }
+
+    void desactivarModoAleatorio() {
+        modoAleatorio = false;
+        mezclaInteligente = false;
+    }
+
+    bool estaEnModoAleatorio() const {
+        return modoAleatorio;
+    }
+
+    bool estaEnMezclaInteligente() const {
+        return mezclaInteligente;
+    }
+
+    // Saltar la canción actual: cuenta en su contra para la mezcla inteligente
+    bool saltarCancion() {
+        if (cancionActual < 0) {
+            return false;
+        }
+
+        canciones.obtener(cancionActual).saltos++;
+        if (mezclaInteligente && mezclaConstruida()) {
+            int artista = artistaDeCancion.obtener(cancionActual);
+            tablasArtista.obtener(artista).establecerPeso(posicionEnArtista.obtener(cancionActual),
+                                                          pesoCancionMezcla(cancionActual));
+            tablaMezcla.establecerPeso(artista, pesoArtistaMezcla(artista));
+        }
+        return siguiente();
+    }
+
+    uint64_t obtenerSemillaAleatoria() const {
+        return semillaAleatoria;
+    }
+
     bool estaReproduciendo() const {
         return reproduciendo;
     }
 
     // Métodos para la cola de reproducción
     void encolarCancion(int indice) {
-        if (indice >= 0 && indice < canciones.obtenerTamanio()) {
-            colaReproduccion.encolar(indice);
+        if (existeCancion(indice)) {
+            guardarEstado();
+            colaReproduccion.agregarAlFinal(indice);
+        }
+    }
+
+    // Encolar de una vez las canciones de una lista a partir de la posición indicada;
+    // devuelve cuántas se encolaron (se omiten los índices inválidos)
+    int encolarCanciones(const Lista<int>& indices, int desde = 0) {
+        Lista<int> validas;
+        validas.reservar(std::max(0, indices.obtenerTamanio() - desde));
+        for (int i = std::max(0, desde); i < indices.obtenerTamanio(); i++) {
+            int cancion = indices.obtener(i);
+            if (existeCancion(cancion)) {
+                validas.agregar(cancion);
+            }
         }
+
+        if (validas.obtenerTamanio() > 0) {
+            guardarEstado();
+            colaReproduccion.agregarVarios(validas);
+        }
+        return validas.obtenerTamanio();
+    }
+
+    // Poner una canción al frente de la cola para que suene a continuación
+    bool encolarSiguiente(int indice) {
+        if (!existeCancion(indice)) {
+            return false;
+        }
+        guardarEstado();
+        colaReproduccion.agregarAlFrente(indice);
+        return true;
     }
 
     bool desencolarCancion() {
-        return colaReproduccion.desencolar();
+        return eliminarDeCola(0);
+    }
+
+    bool eliminarDeCola(int posicion) {
+        if (posicion < 0 || posicion >= colaReproduccion.obtenerTamanio()) {
+            return false;
+        }
+        guardarEstado();
+        return colaReproduccion.eliminar(posicion);
+    }
+
+    bool moverEnCola(int desde, int hasta) {
+        if (desde < 0 || desde >= colaReproduccion.obtenerTamanio() ||
+            hasta < 0 || hasta >= colaReproduccion.obtenerTamanio()) {
+            return false;
+        }
+        if (desde != hasta) {
+            guardarEstado();
+            colaReproduccion.mover(desde, hasta);
+        }
+        return true;
+    }
+
+    void vaciarCola() {
+        if (!colaReproduccion.estaVacia()) {
+            guardarEstado();
+            colaReproduccion.vaciar();
+        }
     }
 
     int obtenerSiguienteEnCola() const {
@@ -1085,6 +7086,14 @@ public:
         return -1;
     }
 
+    // Canción en la posición indicada de la cola (0 es la siguiente)
+    int obtenerCancionEnCola(int posicion) const {
+        if (posicion < 0 || posicion >= colaReproduccion.obtenerTamanio()) {
+            return -1;
+        }
+        return colaReproduccion.obtener(posicion);
+    }
+
     int obtenerTamanioCola() const {
         return colaReproduccion.obtenerTamanio();
     }
@@ -1092,24 +7101,55 @@ public:
     // Métodos para el historial
     int obtenerUltimaCancionHistorial() const {
         if (!historial.estaVacia()) {
-            return historial.cima();
+            return historial.obtener(historial.obtenerTamanio() - 1);
         }
         return -1;
     }
 
+    // Canción del historial por su distancia a la última reproducida (0 es la última)
+    int obtenerCancionHistorial(int posicion) const {
+        if (posicion < 0 || posicion >= historial.obtenerTamanio()) {
+            return -1;
+        }
+        return historial.obtener(historial.obtenerTamanio() - 1 - posicion);
+    }
+
     int obtenerTamanioHistorial() const {
         return historial.obtenerTamanio();
     }
 
+    int obtenerCapacidadHistorial() const {
+        return limiteHistorial;
+    }
+
+    // Cambiar cuántas canciones recuerda el historial; si se reduce, se olvidan las más antiguas
+    bool establecerCapacidadHistorial(int capacidad) {
+        if (capacidad < 1) {
+            return false;
+        }
+        if (historial.obtenerTamanio() > capacidad) {
+            guardarEstado();
+        }
+        limiteHistorial = capacidad;
+        while (historial.obtenerTamanio() > limiteHistorial) {
+            historial.quitarDelFrente();
+        }
+        return true;
+    }
+
     void limpiarHistorial() {
-        historial.vaciar();
+        if (!historial.estaVacia()) {
+            guardarEstado();
+            historial.vaciar();
+        }
     }
 
     // Métodos para listas de reproducción
-    ListaReproduccion obtenerListaReproduccion(int indice) const {
+    const ListaReproduccion& obtenerListaReproduccion(int indice) const {
         if (indice < 0 || indice >= listasReproduccion.obtenerTamanio()) {
             // Devolver una lista vacía en caso de error
-            return ListaReproduccion();
+            static const ListaReproduccion listaVacia;
+            return listaVacia;
         }
         return listasReproduccion.obtener(indice);
     }
@@ -1119,35 +7159,47 @@ public:
     }
 
     // Métodos para recomendaciones
-    Lista<int> obtenerRecomendaciones(int indiceCancion) const {
+    // Puntúa a los artistas cercanos en el grafo de afinidad (por peso de las aristas y
+    // número de saltos) y devuelve las mejores canciones de esos artistas
+    Lista<int> obtenerRecomendaciones(int indiceCancion, int cantidad = 10) const {
         Lista<int> recomendaciones;
 
         try {
-            if (indiceCancion < 0 || indiceCancion >= canciones.obtenerTamanio()) {
+            if (!existeCancion(indiceCancion)) {
+                return recomendaciones;
+            }
+
+            const Cancion& cancion = canciones.obtener(indiceCancion);
+            int artista = grafoAfinidad.buscarVertice(cancion.artista);
+            if (artista == -1) {
                 return recomendaciones;
             }
 
-            Cancion cancion = canciones.obtener(indiceCancion);
+            grafoAfinidad.obtenerVecinosPonderados(artista, PROFUNDIDAD_RECOMENDACION,
+                                                   ANCHO_HAZ_RECOMENDACION, afinesRecomendacion);
+            recomendaciones = seleccionarRecomendaciones(afinesRecomendacion, indiceCancion, artista, cantidad);
+        } catch (const std::exception& e) {
+            std::cerr << "Error al obtener recomendaciones: " << e.what() << std::endl;
+        }
 
-            // Obtener artistas similares
-            Lista<std::string> artistasSimilares = grafoAfinidad.obtenerVecinosDFS(cancion.artista);
+        return recomendaciones;
+    }
 
-            // Buscar canciones con artistas similares
-            for (int i = 0; i < canciones.obtenerTamanio(); i++) {
-                if (i != indiceCancion) {
-                    Cancion candidata = canciones.obtener(i);
-
-                    // Verificar si el artista es similar
-                    for (int j = 0; j < artistasSimilares.obtenerTamanio(); j++) {
-                        if (candidata.artista == artistasSimilares.obtener(j)) {
-                            recomendaciones.agregar(i);
-                            break;
-                        }
-                    }
-                }
+    // Recomendaciones por PageRank personalizado desde el artista y los géneros de la canción
+    // El paseo se calcula una vez por conjunto de semillas y se reutiliza mientras el grafo no cambie
+    Lista<int> obtenerRecomendacionesPageRank(int indiceCancion, int cantidad = 10) const {
+        Lista<int> recomendaciones;
+
+        try {
+            if (!existeCancion(indiceCancion)) {
+                return recomendaciones;
             }
+
+            const Cancion& cancion = canciones.obtener(indiceCancion);
+            recomendaciones = seleccionarRecomendaciones(obtenerPageRank(cancion), indiceCancion,
+                                                         grafoAfinidad.buscarVertice(cancion.artista), cantidad);
         } catch (const std::exception& e) {
-            std::cerr << "Error al obtener recomendaciones: " << e.what() << std::endl;
+            std::cerr << "Error al obtener recomendaciones por PageRank: " << e.what() << std::endl;
         }
 
         return recomendaciones;
@@ -1189,7 +7241,7 @@ private:
 
             // Mostrar información de reproducción actual
             if (reproductor.obtenerCancionActual() != -1) {
-                Cancion cancionActual = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
+                const Cancion& cancionActual = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
                 std::cout << "Reproduciendo: " << cancionActual.titulo << " - " << cancionActual.artista;
                 if (reproductor.estaReproduciendo()) {
                     std::cout << " [▶]";
@@ -1231,13 +7283,17 @@ private:
             std::cout << "Ordenar por:" << std::endl;
             std::cout << "1. Título" << std::endl;
             std::cout << "2. Artista" << std::endl;
-            std::cout << "0. Volver sin ordenar" << std::endl;
+            std::cout << "3. Álbum" << std::endl;
+            std::cout << "4. Año" << std::endl;
+            std::cout << "5. Duración" << std::endl;
+            std::cout << "6. Orden de llegada" << std::endl;
+            std::cout << "0. Mantener el orden actual" << std::endl;
             std::cout << "Ingrese una opción: ";
 
             int opcionOrden = leerOpcion();
             bool ascendente = true;
 
-            if (opcionOrden >= 1 && opcionOrden <= 2) {
+            if (opcionOrden >= 1 && opcionOrden <= 6) {
                 std::cout << "Orden:" << std::endl;
                 std::cout << "1. Ascendente" << std::endl;
                 std::cout << "2. Descendente" << std::endl;
@@ -1246,14 +7302,11 @@ private:
                 int opcionDireccion = leerOpcion();
                 ascendente = (opcionDireccion != 2);
 
-                switch (opcionOrden) {
-                    case 1:
-                        reproductor.ordenarPorTitulo(ascendente);
-                        break;
-                    case 2:
-                        reproductor.ordenarPorArtista(ascendente);
-                        break;
-                }
+                const ReproductorMusica::CampoOrden campos[] = {
+                    ReproductorMusica::ORDEN_TITULO, ReproductorMusica::ORDEN_ARTISTA,
+                    ReproductorMusica::ORDEN_ALBUM, ReproductorMusica::ORDEN_ANIO,
+                    ReproductorMusica::ORDEN_DURACION, ReproductorMusica::ORDEN_INSERCION};
+                reproductor.establecerOrden(campos[opcionOrden - 1], ascendente);
             }
 
             limpiarPantalla();
@@ -1268,9 +7321,10 @@ private:
 
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
 
-            // Mostrar canciones
-            for (int i = 0; i < reproductor.obtenerNumCanciones(); i++) {
-                Cancion cancion = reproductor.obtenerCancion(i);
+            // Mostrar canciones en el orden elegido, con su índice estable
+            for (int posicion = 0; posicion < reproductor.obtenerNumCanciones(); posicion++) {
+                int i = reproductor.obtenerCancionEnOrden(posicion);
+                const Cancion& cancion = reproductor.obtenerCancion(i);
 
                 std::cout << UTF8Util::formatearTexto(std::to_string(i), 8) << " | ";
                 std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
@@ -1296,7 +7350,7 @@ private:
 
             // Mostrar listas de reproducción
             for (int i = 0; i < reproductor.obtenerNumListasReproduccion(); i++) {
-                ListaReproduccion lista = reproductor.obtenerListaReproduccion(i);
+                const ListaReproduccion& lista = reproductor.obtenerListaReproduccion(i);
 
                 std::cout << i << ". " << lista.nombre << " (" << lista.obtenerNumCanciones() << " canciones)" << std::endl;
             }
@@ -1318,7 +7372,7 @@ private:
     void mostrarContenidoLista(int indiceLista) {
         try {
             limpiarPantalla();
-            ListaReproduccion lista = reproductor.obtenerListaReproduccion(indiceLista);
+            const ListaReproduccion& lista = reproductor.obtenerListaReproduccion(indiceLista);
 
             std::cout << UTF8Util::formatearTitulo("LISTA: " + lista.nombre) << std::endl;
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
@@ -1344,7 +7398,7 @@ private:
             // Mostrar canciones de la lista
             for (int i = 0; i < lista.canciones.obtenerTamanio(); i++) {
                 int indiceCancion = lista.canciones.obtener(i);
-                Cancion cancion = reproductor.obtenerCancion(indiceCancion);
+                const Cancion& cancion = reproductor.obtenerCancion(indiceCancion);
 
                 std::cout << UTF8Util::formatearTexto(std::to_string(i + 1), 4) << " | ";
                 std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
@@ -1371,7 +7425,7 @@ private:
     // Reproducir una lista de reproducción
     void reproducirLista(int indiceLista) {
         try {
-            ListaReproduccion lista = reproductor.obtenerListaReproduccion(indiceLista);
+            const ListaReproduccion& lista = reproductor.obtenerListaReproduccion(indiceLista);
 
             if (lista.obtenerNumCanciones() == 0) {
                 std::cout << "Esta lista está vacía." << std::endl;
@@ -1383,10 +7437,7 @@ private:
             reproductor.reproducir(indiceCancion);
 
             // Encolar el resto de canciones
-            for (int i = 1; i < lista.canciones.obtenerTamanio(); i++) {
-                indiceCancion = lista.canciones.obtener(i);
-                reproductor.encolarCancion(indiceCancion);
-            }
+            reproductor.encolarCanciones(lista.canciones, 1);
 
             std::cout << "Reproduciendo lista: " << lista.nombre << std::endl;
             mostrarReproduccionActual();
@@ -1405,12 +7456,24 @@ private:
             std::cout << "Buscar por:" << std::endl;
             std::cout << "1. Título" << std::endl;
             std::cout << "2. Artista" << std::endl;
+            std::cout << "3. Autocompletar (título, artista o álbum)" << std::endl;
+            std::cout << "4. Todos los campos (título, artista o álbum)" << std::endl;
+            std::cout << "5. Consulta avanzada (p. ej. artist:queen year:1970..1980 genre:rock dur:<300)" << std::endl;
             std::cout << "0. Volver" << std::endl;
             std::cout << "Ingrese una opción: ";
 
             int opcion = leerOpcion();
 
-            if (opcion >= 1 && opcion <= 2) {
+            if (opcion == 3) {
+                autocompletarCanciones();
+            } else if (opcion == 5) {
+                std::cout << "Filtros: title, artist, album, genre (texto), year y dur (a..b, <n, >=n...)" << std::endl;
+                std::cout << "Ingrese la consulta: ";
+                std::string consulta;
+                std::getline(std::cin, consulta);
+
+                mostrarResultadosBusqueda(reproductor.buscarConConsulta(consulta));
+            } else if (opcion == 1 || opcion == 2 || opcion == 4) {
                 std::cout << "Ingrese el término de búsqueda: ";
                 std::string termino;
                 std::getline(std::cin, termino);
@@ -1424,6 +7487,19 @@ private:
                     case 2:
                         resultados = reproductor.buscarCancionesPorArtista(termino);
                         break;
+                    case 4:
+                        resultados = reproductor.buscarCancionesEnTodo(termino);
+                        break;
+                }
+
+                // Sin coincidencias exactas: repetir admitiendo errores de escritura
+                int tolerancia = ReproductorMusica::toleranciaSugerida(termino);
+                if (resultados.estaVacia() && opcion != 4 && tolerancia > 0) {
+                    resultados = opcion == 1 ? reproductor.buscarCancionesPorTitulo(termino, tolerancia)
+                                             : reproductor.buscarCancionesPorArtista(termino, tolerancia);
+                    if (!resultados.estaVacia()) {
+                        std::cout << "Sin coincidencias exactas; mostrando resultados aproximados." << std::endl;
+                    }
                 }
 
                 mostrarResultadosBusqueda(resultados);
@@ -1433,6 +7509,102 @@ private:
         }
     }
 
+    // Búsqueda incremental: cada carácter nuevo parte de la posición anterior
+    void autocompletarCanciones() {
+        const int NUM_SUGERENCIAS = 10;
+
+        try {
+            std::string prefijo;
+            Lista<TriePrefijos::Posicion> posiciones;
+            posiciones.agregar(reproductor.iniciarAutocompletado());
+            Lista<int> sugerencias;
+
+            while (true) {
+                limpiarPantalla();
+                std::cout << UTF8Util::formatearTitulo("AUTOCOMPLETAR") << std::endl;
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+                std::cout << "Prefijo: " << prefijo << std::endl;
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+
+                const TriePrefijos::Posicion& actual = posiciones.obtener(posiciones.obtenerTamanio() - 1);
+                sugerencias = reproductor.obtenerSugerencias(actual, NUM_SUGERENCIAS);
+
+                if (prefijo.empty()) {
+                    std::cout << "Escriba para ver sugerencias." << std::endl;
+                } else if (sugerencias.estaVacia()) {
+                    std::cout << "Sin sugerencias." << std::endl;
+                } else {
+                    for (int indice : sugerencias) {
+                        const Cancion& cancion = reproductor.obtenerCancion(indice);
+                        std::cout << UTF8Util::formatearTexto(std::to_string(indice), 8) << " | ";
+                        std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
+                        std::cout << UTF8Util::formatearTexto(cancion.artista, 20) << " | ";
+                        std::cout << cancion.reproducciones << " reproducciones" << std::endl;
+                    }
+                }
+
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+                std::cout << "Siga escribiendo ('-' borra el último carácter, Enter vacío termina): ";
+                std::string entrada;
+                std::getline(std::cin, entrada);
+
+                if (entrada.empty()) {
+                    break;
+                }
+
+                if (entrada == "-") {
+                    if (posiciones.obtenerTamanio() > 1) {
+                        posiciones.eliminar(posiciones.obtenerTamanio() - 1);
+                        prefijo.erase(prefijo.length() - 1);
+                    }
+                    continue;
+                }
+
+                // El índice guarda claves de colación: normalizar también lo escrito
+                for (char c : Colacion::normalizar(entrada)) {
+                    TriePrefijos::Posicion siguiente = posiciones.obtener(posiciones.obtenerTamanio() - 1);
+                    reproductor.avanzarAutocompletado(siguiente, c);
+                    posiciones.agregar(siguiente);
+                    prefijo += c;
+                }
+            }
+
+            if (!prefijo.empty()) {
+                mostrarResultadosBusqueda(sugerencias);
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error al autocompletar: " << e.what() << std::endl;
+        }
+    }
+
+    // Mostrar los géneros más frecuentes entre los resultados y cuántos tiene cada uno
+    void mostrarFacetasGenero(const Lista<int>& resultados) {
+        const int MAX_FACETAS = 8;
+        Lista<int> conteos = reproductor.contarGeneros(resultados);
+
+        Lista<int> generos;
+        for (int genero = 0; genero < conteos.obtenerTamanio(); genero++) {
+            if (conteos.obtener(genero) > 0) {
+                generos.agregar(genero);
+            }
+        }
+        if (generos.estaVacia()) {
+            return;
+        }
+
+        Ordenamiento<int>::ordenar(generos, [&conteos](int a, int b) {
+            return conteos.obtener(a) > conteos.obtener(b);
+        });
+
+        std::cout << "Géneros:";
+        for (int i = 0; i < generos.obtenerTamanio() && i < MAX_FACETAS; i++) {
+            int genero = generos.obtener(i);
+            std::cout << (i == 0 ? " " : ", ") << reproductor.obtenerNombreGenero(genero)
+                      << " (" << conteos.obtener(genero) << ")";
+        }
+        std::cout << std::endl;
+    }
+
     // Mostrar resultados de búsqueda
     void mostrarResultadosBusqueda(const Lista<int>& resultados) {
         try {
@@ -1459,7 +7631,7 @@ private:
             // Mostrar resultados
             for (int i = 0; i < resultados.obtenerTamanio(); i++) {
                 int indice = resultados.obtener(i);
-                Cancion cancion = reproductor.obtenerCancion(indice);
+                const Cancion& cancion = reproductor.obtenerCancion(indice);
 
                 std::cout << UTF8Util::formatearTexto(std::to_string(indice), 8) << " | ";
                 std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
@@ -1468,25 +7640,39 @@ private:
             }
 
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
+            mostrarFacetasGenero(resultados);
             std::cout << "Opciones:" << std::endl;
             std::cout << "1. Reproducir una canción" << std::endl;
             std::cout << "2. Agregar una canción a la cola" << std::endl;
+            std::cout << "3. Eliminar una canción de la biblioteca" << std::endl;
+            std::cout << "4. Reproducir una canción a continuación" << std::endl;
             std::cout << "0. Volver" << std::endl;
             std::cout << "Ingrese una opción: ";
 
             int opcion = leerOpcion();
 
-            if (opcion == 1 || opcion == 2) {
+            if (opcion >= 1 && opcion <= 4) {
                 std::cout << "Ingrese el índice de la canción: ";
                 int indice = leerOpcion();
 
-                if (indice >= 0 && indice < reproductor.obtenerNumCanciones()) {
+                if (reproductor.existeCancion(indice)) {
                     if (opcion == 1) {
                         reproductor.reproducir(indice);
                         std::cout << "Reproduciendo canción." << std::endl;
-                    } else {
+                    } else if (opcion == 2) {
                         reproductor.encolarCancion(indice);
                         std::cout << "Canción agregada a la cola." << std::endl;
+                    } else if (opcion == 4) {
+                        reproductor.encolarSiguiente(indice);
+                        std::cout << "La canción sonará a continuación." << std::endl;
+                    } else {
+                        std::cout << "¿Eliminar \"" << reproductor.obtenerCancion(indice).titulo
+                                  << "\" de la biblioteca? (1. Sí / 0. No): ";
+                        if (leerOpcion() == 1 && reproductor.eliminarCancion(indice)) {
+                            std::cout << "Canción eliminada de la biblioteca." << std::endl;
+                        } else {
+                            std::cout << "La canción se conserva." << std::endl;
+                        }
                     }
                 } else {
                     std::cout << "Índice inválido." << std::endl;
@@ -1512,7 +7698,7 @@ private:
 
             int indice = leerOpcion();
 
-            if (indice >= 0 && indice < reproductor.obtenerNumCanciones()) {
+            if (reproductor.existeCancion(indice)) {
                 reproductor.reproducir(indice);
                 std::cout << "Reproduciendo canción." << std::endl;
                 mostrarReproduccionActual();
@@ -1536,7 +7722,7 @@ private:
                 return;
             }
 
-            Cancion cancion = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
+            const Cancion& cancion = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
 
             std::cout << "Título: " << cancion.titulo << std::endl;
             std::cout << "Artista: " << cancion.artista << std::endl;
@@ -1554,6 +7740,10 @@ private:
             std::cout << std::endl;
 
             std::cout << "Estado: " << (reproductor.estaReproduciendo() ? "Reproduciendo" : "Pausado") << std::endl;
+            if (reproductor.estaEnModoAleatorio()) {
+                std::cout << "Modo aleatorio: " << (reproductor.estaEnMezclaInteligente() ? "inteligente" : "uniforme")
+                          << " (semilla " << reproductor.obtenerSemillaAleatoria() << ")" << std::endl;
+            }
 
             // Simulación de barra de progreso
             int duracionTotal = cancion.duracion;
@@ -1587,6 +7777,10 @@ private:
             std::cout << "1. " << (reproductor.estaReproduciendo() ? "Pausar" : "Reanudar") << std::endl;
             std::cout << "2. Anterior" << std::endl;
             std::cout << "3. Siguiente" << std::endl;
+            std::cout << "4. Deshacer (" << reproductor.obtenerPasosDeshacer() << ")" << std::endl;
+            std::cout << "5. Rehacer (" << reproductor.obtenerPasosRehacer() << ")" << std::endl;
+            std::cout << "6. " << (reproductor.estaEnModoAleatorio() ? "Desactivar" : "Activar") << " modo aleatorio" << std::endl;
+            std::cout << "7. Saltar canción" << std::endl;
             std::cout << "0. Volver" << std::endl;
             std::cout << "Ingrese una opción: ";
 
@@ -1619,6 +7813,43 @@ private:
                     }
                     mostrarReproduccionActual();
                     break;
+                case 4:
+                    if (!reproductor.deshacer()) {
+                        std::cout << "No hay acciones para deshacer." << std::endl;
+                    }
+                    mostrarReproduccionActual();
+                    break;
+                case 5:
+                    if (!reproductor.rehacer()) {
+                        std::cout << "No hay acciones para rehacer." << std::endl;
+                    }
+                    mostrarReproduccionActual();
+                    break;
+                case 6:
+                    if (reproductor.estaEnModoAleatorio()) {
+                        reproductor.desactivarModoAleatorio();
+                    } else {
+                        std::cout << "Tipo de mezcla (1. Uniforme, 2. Inteligente): ";
+                        int tipo = leerOpcion();
+                        std::cout << "Ingrese una semilla (0 para una al azar): ";
+                        int semilla = leerOpcion();
+                        if (semilla == 0) {
+                            semilla = rand();
+                        }
+                        if (tipo == 2) {
+                            reproductor.activarMezclaInteligente(static_cast<uint64_t>(semilla));
+                        } else {
+                            reproductor.activarModoAleatorio(static_cast<uint64_t>(semilla));
+                        }
+                    }
+                    mostrarReproduccionActual();
+                    break;
+                case 7:
+                    if (!reproductor.saltarCancion()) {
+                        std::cout << "No hay más canciones en la cola." << std::endl;
+                    }
+                    mostrarReproduccionActual();
+                    break;
             }
         } catch (const std::exception& e) {
             std::cerr << "Error al mostrar reproducción actual: " << e.what() << std::endl;
@@ -1628,29 +7859,95 @@ private:
     // Mostrar cola de reproducción
     void mostrarColaReproduccion() {
         try {
-            limpiarPantalla();
-            std::cout << UTF8Util::formatearTitulo("COLA DE REPRODUCCI" + UTF8Util::O_ACENTO() + "N") << std::endl;
-            std::cout << UTF8Util::formatearLinea(80) << std::endl;
+            const int cancionesPorPagina = 20;
+            int pagina = 0;
 
-            if (reproductor.obtenerTamanioCola() == 0) {
-                std::cout << "La cola de reproducción está vacía." << std::endl;
-                return;
-            }
+            while (true) {
+                limpiarPantalla();
+                std::cout << UTF8Util::formatearTitulo("COLA DE REPRODUCCI" + UTF8Util::O_ACENTO() + "N") << std::endl;
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
 
-            std::cout << "Próxima canción:" << std::endl;
-            std::cout << UTF8Util::formatearLinea(80) << std::endl;
+                int total = reproductor.obtenerTamanioCola();
+                if (total == 0) {
+                    std::cout << "La cola de reproducción está vacía." << std::endl;
+                    return;
+                }
 
-            int siguienteEnCola = reproductor.obtenerSiguienteEnCola();
-            if (siguienteEnCola != -1) {
-                Cancion cancion = reproductor.obtenerCancion(siguienteEnCola);
+                int paginas = (total + cancionesPorPagina - 1) / cancionesPorPagina;
+                pagina = std::min(pagina, paginas - 1);
 
-                std::cout << "Título: " << cancion.titulo << std::endl;
-                std::cout << "Artista: " << cancion.artista << std::endl;
-                std::cout << "Álbum: " << cancion.album << std::endl;
-            }
+                // Mostrar encabezados de columnas
+                std::cout << UTF8Util::formatearTexto("Nº", 8) << " | ";
+                std::cout << UTF8Util::formatearTexto("Título", 30) << " | ";
+                std::cout << UTF8Util::formatearTexto("Artista", 20) << " | ";
+                std::cout << UTF8Util::formatearTexto("Álbum", 14) << std::endl;
 
-            std::cout << UTF8Util::formatearLinea(80) << std::endl;
-            std::cout << "Total de canciones en cola: " << reproductor.obtenerTamanioCola() << std::endl;
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+
+                int primera = pagina * cancionesPorPagina;
+                int ultima = std::min(total, primera + cancionesPorPagina);
+                for (int posicion = primera; posicion < ultima; posicion++) {
+                    const Cancion& cancion = reproductor.obtenerCancion(reproductor.obtenerCancionEnCola(posicion));
+
+                    std::cout << UTF8Util::formatearTexto(std::to_string(posicion + 1), 8) << " | ";
+                    std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
+                    std::cout << UTF8Util::formatearTexto(cancion.artista, 20) << " | ";
+                    std::cout << UTF8Util::formatearTexto(cancion.album, 14) << std::endl;
+                }
+
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+                std::cout << "Total de canciones en cola: " << total
+                          << " (página " << (pagina + 1) << " de " << paginas << ")" << std::endl;
+
+                std::cout << UTF8Util::formatearLinea(80) << std::endl;
+                std::cout << "Opciones:" << std::endl;
+                std::cout << "1. Página siguiente" << std::endl;
+                std::cout << "2. Página anterior" << std::endl;
+                std::cout << "3. Quitar una canción de la cola" << std::endl;
+                std::cout << "4. Mover una canción de la cola" << std::endl;
+                std::cout << "5. Vaciar la cola" << std::endl;
+                std::cout << "0. Volver" << std::endl;
+                std::cout << "Ingrese una opción: ";
+
+                int opcion = leerOpcion();
+
+                switch (opcion) {
+                    case 1:
+                        if (pagina + 1 < paginas) {
+                            pagina++;
+                        }
+                        break;
+                    case 2:
+                        if (pagina > 0) {
+                            pagina--;
+                        }
+                        break;
+                    case 3: {
+                        std::cout << "Ingrese la posición en la cola: ";
+                        int posicion = leerOpcion();
+                        if (!reproductor.eliminarDeCola(posicion - 1)) {
+                            std::cout << "Posición inválida." << std::endl;
+                        }
+                        break;
+                    }
+                    case 4: {
+                        std::cout << "Ingrese la posición actual: ";
+                        int desde = leerOpcion();
+                        std::cout << "Ingrese la nueva posición: ";
+                        int hasta = leerOpcion();
+                        if (!reproductor.moverEnCola(desde - 1, hasta - 1)) {
+                            std::cout << "Posición inválida." << std::endl;
+                        }
+                        break;
+                    }
+                    case 5:
+                        reproductor.vaciarCola();
+                        std::cout << "Cola vaciada." << std::endl;
+                        return;
+                    default:
+                        return;
+                }
+            }
         } catch (const std::exception& e) {
             std::cerr << "Error al mostrar cola de reproducción: " << e.what() << std::endl;
         }
@@ -1668,25 +7965,33 @@ private:
                 return;
             }
 
-            std::cout << "Última canción reproducida:" << std::endl;
+            // Mostrar encabezados de columnas
+            std::cout << UTF8Util::formatearTexto("Nº", 4) << " | ";
+            std::cout << UTF8Util::formatearTexto("Título", 30) << " | ";
+            std::cout << UTF8Util::formatearTexto("Artista", 20) << " | ";
+            std::cout << UTF8Util::formatearTexto("Álbum", 20) << std::endl;
+
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
 
-            int ultimaCancion = reproductor.obtenerUltimaCancionHistorial();
-            if (ultimaCancion != -1) {
-                Cancion cancion = reproductor.obtenerCancion(ultimaCancion);
+            // De la más reciente a la más antigua
+            for (int i = 0; i < reproductor.obtenerTamanioHistorial(); i++) {
+                const Cancion& cancion = reproductor.obtenerCancion(reproductor.obtenerCancionHistorial(i));
 
-                std::cout << "Título: " << cancion.titulo << std::endl;
-                std::cout << "Artista: " << cancion.artista << std::endl;
-                std::cout << "Álbum: " << cancion.album << std::endl;
+                std::cout << UTF8Util::formatearTexto(std::to_string(i + 1), 4) << " | ";
+                std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
+                std::cout << UTF8Util::formatearTexto(cancion.artista, 20) << " | ";
+                std::cout << UTF8Util::formatearTexto(cancion.album, 20) << std::endl;
             }
 
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
-            std::cout << "Total de canciones en historial: " << reproductor.obtenerTamanioHistorial() << std::endl;
+            std::cout << "Total de canciones en historial: " << reproductor.obtenerTamanioHistorial()
+                      << " de " << reproductor.obtenerCapacidadHistorial() << std::endl;
 
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
             std::cout << "Opciones:" << std::endl;
             std::cout << "1. Limpiar historial" << std::endl;
             std::cout << "2. Volver a la última canción" << std::endl;
+            std::cout << "3. Cambiar capacidad del historial" << std::endl;
             std::cout << "0. Volver" << std::endl;
             std::cout << "Ingrese una opción: ";
 
@@ -1705,6 +8010,16 @@ private:
                         std::cout << "No hay canciones anteriores en el historial." << std::endl;
                     }
                     break;
+                case 3: {
+                    std::cout << "Ingrese la nueva capacidad: ";
+                    int capacidad = leerOpcion();
+                    if (reproductor.establecerCapacidadHistorial(capacidad)) {
+                        std::cout << "El historial recordará hasta " << capacidad << " canciones." << std::endl;
+                    } else {
+                        std::cout << "La capacidad debe ser al menos 1." << std::endl;
+                    }
+                    break;
+                }
             }
         } catch (const std::exception& e) {
             std::cerr << "Error al mostrar historial: " << e.what() << std::endl;
@@ -1723,11 +8038,19 @@ private:
                 return;
             }
 
-            Cancion cancionActual = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
+            const Cancion& cancionActual = reproductor.obtenerCancion(reproductor.obtenerCancionActual());
             std::cout << "Basado en: " << cancionActual.titulo << " - " << cancionActual.artista << std::endl;
             std::cout << UTF8Util::formatearLinea(80) << std::endl;
 
-            Lista<int> recomendaciones = reproductor.obtenerRecomendaciones(reproductor.obtenerCancionActual());
+            std::cout << "Método:" << std::endl;
+            std::cout << "1. Artistas afines" << std::endl;
+            std::cout << "2. PageRank personalizado" << std::endl;
+            std::cout << "Ingrese una opción: ";
+
+            int metodo = leerOpcion();
+            Lista<int> recomendaciones = metodo == 2
+                                             ? reproductor.obtenerRecomendacionesPageRank(reproductor.obtenerCancionActual())
+                                             : reproductor.obtenerRecomendaciones(reproductor.obtenerCancionActual());
 
             if (recomendaciones.obtenerTamanio() == 0) {
                 std::cout << "No se encontraron recomendaciones." << std::endl;
@@ -1748,7 +8071,7 @@ private:
             // Mostrar recomendaciones
             for (int i = 0; i < recomendaciones.obtenerTamanio(); i++) {
                 int indice = recomendaciones.obtener(i);
-                Cancion cancion = reproductor.obtenerCancion(indice);
+                const Cancion& cancion = reproductor.obtenerCancion(indice);
 
                 std::cout << UTF8Util::formatearTexto(std::to_string(indice), 8) << " | ";
                 std::cout << UTF8Util::formatearTexto(cancion.titulo, 30) << " | ";
@@ -1771,7 +8094,7 @@ private:
                     std::cout << "Ingrese el índice de la canción a reproducir: ";
                     indice = leerOpcion(); // Usar la variable ya declarada
 
-                    if (indice >= 0 && indice < reproductor.obtenerNumCanciones()) {
+                    if (reproductor.existeCancion(indice)) {
                         reproductor.reproducir(indice);
                         std::cout << "Reproduciendo canción." << std::endl;
                         mostrarReproduccionActual();
@@ -1780,10 +8103,7 @@ private:
                     }
                     break;
                 case 2:
-                    for (int i = 0; i < recomendaciones.obtenerTamanio(); i++) {
-                        indice = recomendaciones.obtener(i);
-                        reproductor.encolarCancion(indice);
-                    }
+                    reproductor.encolarCanciones(recomendaciones);
                     std::cout << "Recomendaciones agregadas a la cola." << std::endl;
                     break;
             }
@@ -1865,13 +8185,20 @@ public:
 
 // ==================== FUNCIÓN PRINCIPAL ====================
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         // Inicializar generador de números aleatorios
         srand(static_cast<unsigned int>(time(nullptr)));
 
+        // Conversión única de una biblioteca antigua: --convertir origen destino
+        if (argc == 4 && std::string(argv[1]) == "--convertir") {
+            ConversorBiblioteca::convertir(argv[2], argv[3]);
+            std::cout << "Biblioteca convertida: " << argv[3] << std::endl;
+            return 0;
+        }
+
         // Crear el reproductor de música
-        ReproductorMusica reproductor;
+        ReproductorMusica reproductor(argc > 1 ? argv[1] : "library.dat");
 
         // Crear la interfaz de usuario
         InterfazUsuario interfaz(reproductor);